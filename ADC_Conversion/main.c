@@ -1,7 +1,10 @@
 /**
  * @file main.c
  * @brief ADC to PORTD using ATmega
- * @details This program reads the ADC value from ADC0 and outputs it to PORTD.
+ * @details This program samples ADC0 in free-running mode. The conversion
+ *          complete interrupt stores every result in a circular buffer and
+ *          the main loop outputs the samples to PORTD. With USE_ADC_SCAN set
+ *          to 1 the AVR_Common scan engine samples several channels instead.
  *
  * @author kandyala sai kumar
  * @date 2025
@@ -12,36 +15,135 @@
 
 /** Include standard AVR and utility libraries */
 #include <avr/io.h>
-#include <util/delay.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdint.h>
+
+/** Set to 1 to scan scan_list with AVR_Common/adc_scan.c */
+#ifndef USE_ADC_SCAN
+#define USE_ADC_SCAN  0
+#endif
+
+#if (USE_ADC_SCAN == 1)
+#include "adc_scan.h"
+
+/** Channels scanned, ADC0 comes first and is the one shown on PORTD */
+static const uint8_t scan_list[] = {0U, 1U, 2U};
+#define SCAN_COUNT      ((uint8_t)sizeof(scan_list))
+#define SCAN_PERIOD_US  250U    /* 4 kHz conversions, each channel every 750 us */
+#else
+/** Sample buffer size, must be a power of two not above 256 */
+#define ADC_BUF_SIZE  32U
+#define ADC_BUF_MASK  (ADC_BUF_SIZE - 1U)
+
+/**
+ * @brief Circular buffer filled by the ADC interrupt.
+ *
+ * The ISR only writes adc_head and the main loop only writes adc_tail, both
+ * are single bytes so they are read and written atomically.
+ */
+volatile uint16_t adc_buf[ADC_BUF_SIZE];
+volatile uint8_t adc_head;      ///< Next slot written by the ISR
+volatile uint8_t adc_tail;      ///< Next slot read by the main loop
+volatile uint16_t adc_overruns; ///< Samples dropped because the buffer was full
+
+/**
+ * @brief Starts ADC0 in free-running mode with the conversion interrupt.
+ *
+ * With the prescaler at 128 the ADC clock is 125 kHz and a free-running
+ * conversion takes 13 ADC clocks, one sample every 104 us (9615 Hz).
+ */
+static void ADC_Init(void)
+{
+    /** Select ADC0 channel (MUX[3:0] = 0000) */
+    ADMUX = 0x00; /* Reference voltage is set to AREF (default) */
+
+    /** Auto trigger source: free running (ADTS[2:0] = 000) */
+    ADCSRB = 0x00;
+
+    /** Enable ADC, auto trigger and interrupt, prescaler 128, start the first conversion */
+    ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADSC)
+           | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+}
 
 /** @brief Main function
  *  @return int Always returns 0
  */
 int main(void)
 {
+    uint16_t sample;
+#if (USE_ADC_SCAN == 1)
+    uint16_t sweep[SCAN_COUNT];
+    uint8_t seen = 0U;
+#endif
+
     /** Configure PORTD as output (All pins set as output) */
     DDRD = 0xFF;  /* MISRA Rule: Directly assigning values to registers should be done cautiously */
 
-    /** Select ADC0 channel (MUX[3:0] = 0000) */
-    ADMUX = 0x00; /* Reference voltage is set to AREF (default) */
-
-    /** ADC CONTROL AND STATUS REGISTER FOR ENABLE ADC CONVERSION */
-    ADCSRA = 0x87; /* ADC Enable */
+#if (USE_ADC_SCAN == 1)
+    AdcScan_Init(scan_list, SCAN_COUNT, SCAN_PERIOD_US);
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sei();
 
     while(1)
     {
-        /** Start ADC conversion */
-        ADCSRA |= (1 << ADSC);
+        /** One consistent snapshot of all channels per completed sweep */
+        if (AdcScan_Sequence() != seen)
+        {
+            seen = AdcScan_Read(sweep);
+            sample = sweep[0];
+            PORTD = (uint8_t)(sample & 0xFF); /* MISRA: Explicit typecasting applied */
+        }
+        sleep_mode();
+    }
+#else
+    ADC_Init();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sei();
 
-        /** Wait until conversion is complete (ADSC bit becomes 0) */
-        while ((ADCSRA & (1 << ADSC)) != 0)
+    while(1)
+    {
+        /** Drain every buffered sample, the ISR keeps sampling meanwhile */
+        while (adc_tail != adc_head)
         {
-            /* Do nothing, just wait for ADC conversion to complete */
+            sample = adc_buf[adc_tail];
+            adc_tail = (uint8_t)((adc_tail + 1U) & ADC_BUF_MASK);
+
+            /** Store the ADC result (lower 8 bits) in PORTD */
+            PORTD = (uint8_t)(sample & 0xFF); /* MISRA: Explicit typecasting applied */
         }
 
-        /** Store the ADC result (lower 8 bits) in PORTD */
-        PORTD = (uint8_t)(ADC & 0xFF); /* MISRA: Explicit typecasting applied */
+        /** Nothing left: sleep until the next conversion interrupt */
+        cli();
+        if (adc_tail == adc_head)
+        {
+            sleep_enable();
+            sei(); /* The instruction after sei always runs, so no wakeup is lost */
+            sleep_cpu();
+            sleep_disable();
+        }
+        sei();
     }
+#endif
 
     return 0;
 }
+
+/**
+ * @brief ADC conversion complete interrupt, queues the new result.
+ */
+ISR(ADC_vect)
+{
+    uint8_t next = (uint8_t)((adc_head + 1U) & ADC_BUF_MASK);
+
+    if (next != adc_tail)
+    {
+        adc_buf[adc_head] = ADC;
+        adc_head = next;
+    }
+    else
+    {
+        adc_overruns++;
+    }
+}
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file adc_scan.c
+ * @brief Timer triggered multi-channel ADC scan engine for the ATmega328P
+ *
+ * The mux is changed in the conversion complete interrupt, while no
+ * conversion is running: the next one only starts at the next Timer1 compare
+ * match, so every result belongs to the channel selected before it.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#include "adc_scan.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+static uint8_t scan_channels[ADC_SCAN_MAX_CHANNELS];
+static uint8_t scan_count;
+static uint8_t scan_index;                  ///< Channel being converted
+
+/** Two sweep buffers: the ISR fills the back one while readers copy the front */
+static volatile uint16_t scan_buf[2][ADC_SCAN_MAX_CHANNELS];
+static volatile uint8_t scan_front;         ///< Buffer holding the latest complete sweep
+static volatile uint8_t scan_seq;           ///< Incremented when scan_front changes
+static volatile AdcScan_Callback_t scan_callback;
+
+void AdcScan_Init(const uint8_t *channels, uint8_t count, uint16_t period_us)
+{
+    uint8_t i;
+
+    if (count > ADC_SCAN_MAX_CHANNELS)
+    {
+        count = ADC_SCAN_MAX_CHANNELS;
+    }
+    for (i = 0U; i < count; i++)
+    {
+        scan_channels[i] = channels[i];
+    }
+    scan_count = count;
+    scan_index = 0U;
+
+    /** First channel, then enable ADC and interrupt with prescaler 128 and auto trigger */
+    ADMUX = ADC_SCAN_REF | (scan_channels[0] & 0x0FU);
+    ADCSRB = (1 << ADTS2) | (1 << ADTS0); /* Trigger: Timer1 compare match B */
+    ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE)
+           | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+
+    /** Timer1 CTC at 0.5 us per count (prescaler 8), compare B at TOP */
+    TCCR1A = 0x00;
+    TCCR1B = 0x00;
+    TCNT1 = 0U;
+    OCR1A = (uint16_t)((period_us * 2U) - 1U);
+    OCR1B = OCR1A;
+    TIFR1 = (1 << OCF1B);
+    TCCR1B = (1 << WGM12) | (1 << CS11);
+}
+
+void AdcScan_SetCallback(AdcScan_Callback_t callback)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        scan_callback = callback;
+    }
+}
+
+uint8_t AdcScan_Read(uint16_t *out)
+{
+    uint8_t seq, front, i;
+
+    /** Retry if a new sweep was published while copying */
+    do
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            seq = scan_seq;
+            front = scan_front;
+        }
+        for (i = 0U; i < scan_count; i++)
+        {
+            out[i] = scan_buf[front][i];
+        }
+    } while (seq != scan_seq);
+
+    return seq;
+}
+
+uint8_t AdcScan_Sequence(void)
+{
+    return scan_seq;
+}
+
+/**
+ * @brief ADC conversion complete interrupt, stores the result and selects
+ *        the next channel.
+ */
+ISR(ADC_vect)
+{
+    uint8_t back = (uint8_t)(scan_front ^ 1U);
+    AdcScan_Callback_t callback;
+
+    /** The trigger is the rising edge of OCF1B, clear it to re-arm */
+    TIFR1 = (1 << OCF1B);
+
+    scan_buf[back][scan_index] = ADC;
+    scan_index++;
+    if (scan_index >= scan_count)
+    {
+        scan_index = 0U;
+        scan_front = back;
+        scan_seq++;
+    }
+    ADMUX = ADC_SCAN_REF | (scan_channels[scan_index] & 0x0FU);
+
+    /** After the mux change, so a slow callback cannot delay the next conversion */
+    callback = scan_callback;
+    if ((scan_index == 0U) && (callback != 0))
+    {
+        callback(scan_buf[back]);
+    }
+}
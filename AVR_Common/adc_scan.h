@@ -0,0 +1,73 @@
+/**
+ * @file adc_scan.h
+ * @brief Timer triggered multi-channel ADC scan engine for the ATmega328P
+ *
+ * Timer1 runs in CTC mode and its compare match B starts one conversion per
+ * period (ADC auto trigger source 101). The conversion complete interrupt
+ * stores the result, selects the next channel of the list and, at the end
+ * of a sweep, publishes the sweep as the new front buffer. Readers copy the
+ * front buffer with AdcScan_Read(), which always returns one complete sweep.
+ *
+ * Uses Timer1, the ADC and ISR(ADC_vect); Timer0 and Timer2 stay free.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+#include <stdint.h>
+
+/** Largest channel list accepted by AdcScan_Init() */
+#ifndef ADC_SCAN_MAX_CHANNELS
+#define ADC_SCAN_MAX_CHANNELS  8U
+#endif
+
+/** ADMUX reference bits, 0 keeps the external AREF used by the demos */
+#ifndef ADC_SCAN_REF
+#define ADC_SCAN_REF           0x00U
+#endif
+
+/**
+ * Shortest period between two conversions: an auto triggered conversion
+ * takes 13.5 ADC clocks, 108 us with the ADC clock at 16 MHz / 128.
+ */
+#define ADC_SCAN_MIN_PERIOD_US 112U
+
+/**
+ * @brief Called from the ADC interrupt each time a sweep completes.
+ * @param sweep The new sweep, one result per channel in list order
+ */
+typedef void (*AdcScan_Callback_t)(const volatile uint16_t *sweep);
+
+/**
+ * @brief Starts scanning the channel list.
+ * @param channels ADC channel numbers (0..8), converted in this order
+ * @param count Number of channels, 1..ADC_SCAN_MAX_CHANNELS
+ * @param period_us Time between two conversions in microseconds, at least
+ *        ADC_SCAN_MIN_PERIOD_US and at most 32767
+ * @note Enable interrupts with sei() afterwards.
+ */
+void AdcScan_Init(const uint8_t *channels, uint8_t count, uint16_t period_us);
+
+/**
+ * @brief Installs a function run in interrupt context after every sweep,
+ *        at the fixed sweep rate. Keep it short; NULL removes it.
+ * @param callback Function to call
+ */
+void AdcScan_SetCallback(AdcScan_Callback_t callback);
+
+/**
+ * @brief Copies the latest complete sweep.
+ * @param out Receives one result per channel, in channel list order
+ * @return Sweep sequence number, it changes every time a sweep completes
+ */
+uint8_t AdcScan_Read(uint16_t *out);
+
+/**
+ * @brief Sequence number of the latest complete sweep, cheap to poll.
+ */
+uint8_t AdcScan_Sequence(void);
+
+#endif /* ADC_SCAN_H */
@@ -0,0 +1,249 @@
+/**
+ * @file gamma_pwm.c
+ * @brief Gamma corrected 14-bit LED dimming on Timer1 for the ATmega328P
+ *
+ * OCR1A/OCR1B are double buffered in fast PWM mode and load at BOTTOM, so
+ * writing them from the overflow interrupt changes the next full period and
+ * never produces a glitch.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#include "gamma_pwm.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+/**
+ * round(16383 * (i / 255) ^ 2.2). Neighbouring entries differ by at most
+ * 141, so the interpolation below stays within 16 bits.
+ */
+static const uint16_t gamma_table[256] PROGMEM =
+{
+        0U,     0U,     0U,     1U,     2U,     3U,     4U,     6U,
+        8U,    10U,    13U,    16U,    20U,    23U,    28U,    32U,
+       37U,    42U,    48U,    54U,    61U,    67U,    75U,    82U,
+       90U,    99U,   108U,   117U,   127U,   137U,   148U,   159U,
+      170U,   182U,   195U,   207U,   221U,   234U,   249U,   263U,
+      278U,   294U,   310U,   326U,   343U,   361U,   379U,   397U,
+      416U,   435U,   455U,   475U,   496U,   517U,   539U,   561U,
+      583U,   607U,   630U,   654U,   679U,   704U,   730U,   756U,
+      783U,   810U,   838U,   866U,   894U,   924U,   953U,   983U,
+     1014U,  1045U,  1077U,  1110U,  1142U,  1176U,  1210U,  1244U,
+     1279U,  1314U,  1350U,  1387U,  1424U,  1461U,  1499U,  1538U,
+     1577U,  1617U,  1657U,  1698U,  1739U,  1781U,  1823U,  1866U,
+     1910U,  1954U,  1998U,  2044U,  2089U,  2136U,  2182U,  2230U,
+     2278U,  2326U,  2375U,  2425U,  2475U,  2525U,  2577U,  2629U,
+     2681U,  2734U,  2787U,  2841U,  2896U,  2951U,  3007U,  3063U,
+     3120U,  3178U,  3236U,  3295U,  3354U,  3414U,  3474U,  3535U,
+     3596U,  3658U,  3721U,  3784U,  3848U,  3913U,  3978U,  4043U,
+     4110U,  4176U,  4244U,  4312U,  4380U,  4449U,  4519U,  4589U,
+     4660U,  4732U,  4804U,  4876U,  4950U,  5024U,  5098U,  5173U,
+     5249U,  5325U,  5402U,  5479U,  5557U,  5636U,  5715U,  5795U,
+     5876U,  5957U,  6039U,  6121U,  6204U,  6287U,  6372U,  6456U,
+     6542U,  6628U,  6714U,  6801U,  6889U,  6978U,  7067U,  7156U,
+     7247U,  7337U,  7429U,  7521U,  7614U,  7707U,  7801U,  7896U,
+     7991U,  8087U,  8183U,  8281U,  8378U,  8477U,  8576U,  8675U,
+     8775U,  8876U,  8978U,  9080U,  9183U,  9286U,  9390U,  9495U,
+     9600U,  9706U,  9812U,  9920U, 10027U, 10136U, 10245U, 10355U,
+    10465U, 10576U, 10688U, 10800U, 10913U, 11027U, 11141U, 11256U,
+    11371U, 11487U, 11604U, 11721U, 11840U, 11958U, 12078U, 12198U,
+    12318U, 12440U, 12562U, 12684U, 12807U, 12931U, 13056U, 13181U,
+    13307U, 13433U, 13561U, 13688U, 13817U, 13946U, 14076U, 14206U,
+    14337U, 14469U, 14602U, 14735U, 14868U, 15003U, 15138U, 15273U,
+    15410U, 15547U, 15685U, 15823U, 15962U, 16102U, 16242U, 16383U
+};
+
+/**
+ * Per channel fade state; the level is 8.8 fixed point. The distance is
+ * split in fade_step per period plus a remainder of fade_rem / fade_periods,
+ * carried Bresenham style, so the steps never differ by more than 1/256.
+ */
+static volatile uint16_t fade_pos[GAMMA_PWM_CHANNELS];
+static volatile int16_t fade_step[GAMMA_PWM_CHANNELS];
+static volatile uint16_t fade_left[GAMMA_PWM_CHANNELS];   ///< Periods to go, 0 when idle
+static uint16_t fade_periods[GAMMA_PWM_CHANNELS];         ///< Length of the fade
+static uint16_t fade_rem[GAMMA_PWM_CHANNELS];             ///< |distance % periods|
+static uint16_t fade_acc[GAMMA_PWM_CHANNELS];             ///< Remainder carried so far
+static uint8_t fade_down[GAMMA_PWM_CHANNELS];             ///< 1 when the level decreases
+static uint8_t fade_target[GAMMA_PWM_CHANNELS];
+static uint16_t ocr_applied[GAMMA_PWM_CHANNELS];           ///< Last value written, ISR only
+
+/**
+ * @brief Compare value of an 8.8 level, interpolated between two entries.
+ */
+static uint16_t GammaPwm_Interpolate(uint16_t pos)
+{
+    uint8_t index = (uint8_t)(pos >> 8);
+    uint8_t frac = (uint8_t)pos;
+    uint16_t low = pgm_read_word(&gamma_table[index]);
+
+    if ((frac == 0U) || (index == 255U))
+    {
+        return low;
+    }
+    return (uint16_t)(low + (uint16_t)(((uint16_t)(pgm_read_word(&gamma_table[index + 1U]) - low) * frac) >> 8));
+}
+
+static void GammaPwm_Write(uint8_t channel, uint16_t ocr)
+{
+    if (channel == 0U)
+    {
+        OCR1A = ocr;
+    }
+    else
+    {
+        OCR1B = ocr;
+    }
+}
+
+void GammaPwm_Init(uint8_t outputs)
+{
+    uint8_t ch;
+
+    for (ch = 0U; ch < GAMMA_PWM_CHANNELS; ch++)
+    {
+        fade_pos[ch] = 0U;
+        fade_left[ch] = 0U;
+        ocr_applied[ch] = 0U;
+    }
+
+    /** Mode 14: fast PWM, TOP = ICR1, non-inverting on the selected outputs */
+    TCCR1B = 0x00;
+    TCNT1 = 0U;
+    ICR1 = GAMMA_PWM_TOP;
+    OCR1A = 0U;
+    OCR1B = 0U;
+    TCCR1A = (1 << WGM11);
+    if ((outputs & GAMMA_PWM_OC1A) != 0U)
+    {
+        TCCR1A |= (1 << COM1A1);
+        DDRB |= (1 << DDB1);
+    }
+    if ((outputs & GAMMA_PWM_OC1B) != 0U)
+    {
+        TCCR1A |= (1 << COM1B1);
+        DDRB |= (1 << DDB2);
+    }
+    TIMSK1 &= (uint8_t)~(1 << TOIE1);
+    TCCR1B = (1 << WGM13) | (1 << WGM12) | (1 << CS10); /* Prescaler = 1 */
+}
+
+uint16_t GammaPwm_Lookup(uint8_t level)
+{
+    return pgm_read_word(&gamma_table[level]);
+}
+
+void GammaPwm_Set(uint8_t channel, uint8_t level)
+{
+    GammaPwm_FadeTo(channel, level, 0U);
+}
+
+void GammaPwm_FadeTo(uint8_t channel, uint8_t level, uint16_t duration_ms)
+{
+    uint16_t periods;
+    int32_t distance;
+
+    if (channel >= GAMMA_PWM_CHANNELS)
+    {
+        return;
+    }
+
+    /** 976.5625 periods per second = ms * 125 / 128 */
+    periods = (uint16_t)(((uint32_t)duration_ms * 125U) >> 7);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        fade_target[channel] = level;
+        if (periods < 2U)
+        {
+            /** Set at once; the ISR only runs while something fades */
+            fade_left[channel] = 0U;
+            fade_pos[channel] = (uint16_t)level << 8;
+            ocr_applied[channel] = GammaPwm_Lookup(level);
+            GammaPwm_Write(channel, ocr_applied[channel]);
+        }
+        else
+        {
+            /** 8.8 distance over at least 2 periods fits in 16 bits signed */
+            distance = ((int32_t)level << 8) - (int32_t)fade_pos[channel];
+            fade_step[channel] = (int16_t)(distance / (int32_t)periods);
+            fade_down[channel] = (distance < 0) ? 1U : 0U;
+            if (distance < 0)
+            {
+                distance = -distance;
+            }
+            fade_rem[channel] = (uint16_t)((uint32_t)distance % periods);
+            fade_periods[channel] = periods;
+            fade_acc[channel] = 0U;
+            fade_left[channel] = periods;
+            TIFR1 = (1 << TOV1);
+            TIMSK1 |= (1 << TOIE1);
+        }
+    }
+}
+
+uint8_t GammaPwm_Busy(uint8_t channel)
+{
+    uint16_t left;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        left = fade_left[channel];
+    }
+    return (left != 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief Timer1 overflow interrupt, advances every running fade by one period.
+ */
+ISR(TIMER1_OVF_vect)
+{
+    uint8_t ch;
+    uint8_t active = 0U;
+    uint16_t ocr;
+
+    for (ch = 0U; ch < GAMMA_PWM_CHANNELS; ch++)
+    {
+        if (fade_left[ch] != 0U)
+        {
+            fade_left[ch]--;
+            if (fade_left[ch] == 0U)
+            {
+                /** The carried remainder makes this the last regular step */
+                fade_pos[ch] = (uint16_t)fade_target[ch] << 8;
+            }
+            else
+            {
+                fade_pos[ch] = (uint16_t)(fade_pos[ch] + (uint16_t)fade_step[ch]);
+
+                /** acc + rem could overflow 16 bits, compare against the headroom */
+                if (fade_acc[ch] >= (uint16_t)(fade_periods[ch] - fade_rem[ch]))
+                {
+                    fade_acc[ch] = (uint16_t)(fade_acc[ch] - (uint16_t)(fade_periods[ch] - fade_rem[ch]));
+                    fade_pos[ch] = (fade_down[ch] != 0U) ? (uint16_t)(fade_pos[ch] - 1U)
+                                                         : (uint16_t)(fade_pos[ch] + 1U);
+                }
+                else
+                {
+                    fade_acc[ch] = (uint16_t)(fade_acc[ch] + fade_rem[ch]);
+                }
+                active = 1U;
+            }
+
+            ocr = GammaPwm_Interpolate(fade_pos[ch]);
+            if (ocr != ocr_applied[ch])
+            {
+                ocr_applied[ch] = ocr;
+                GammaPwm_Write(ch, ocr);
+            }
+        }
+    }
+
+    if (active == 0U)
+    {
+        TIMSK1 &= (uint8_t)~(1 << TOIE1);
+    }
+}
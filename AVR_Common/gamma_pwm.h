@@ -0,0 +1,71 @@
+/**
+ * @file gamma_pwm.h
+ * @brief Gamma corrected 14-bit LED dimming on Timer1 for the ATmega328P
+ *
+ * Timer1 runs in fast PWM mode 14 with ICR1 as TOP (16383), 977 Hz at
+ * prescaler 1. Brightness levels 0..255 are perceptual: a gamma 2.2 table in
+ * flash maps them to compare values, so the low end gets the fine steps the
+ * eye notices.
+ *
+ * Fades are computed in the Timer1 overflow interrupt, once per PWM period:
+ * the level advances by an 8.8 step, with the division remainder carried
+ * so the fade ends on the target without a last jump, and the compare value
+ * is interpolated between two table entries, so a fade moves in steps far
+ * smaller than one level. The overflow interrupt is only enabled while a
+ * fade is running.
+ *
+ * Uses Timer1, OC1A (PB1), OC1B (PB2) and ISR(TIMER1_OVF_vect); it cannot be
+ * combined with adc_scan.c, which also uses Timer1.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#ifndef GAMMA_PWM_H
+#define GAMMA_PWM_H
+
+#include <stdint.h>
+
+#define GAMMA_PWM_TOP       16383U ///< ICR1, 14-bit resolution
+#define GAMMA_PWM_CHANNELS  2U     ///< Channel 0: OC1A (PB1), channel 1: OC1B (PB2)
+
+#define GAMMA_PWM_OC1A      0x01U  ///< GammaPwm_Init() mask bit of channel 0
+#define GAMMA_PWM_OC1B      0x02U  ///< GammaPwm_Init() mask bit of channel 1
+
+/**
+ * @brief Starts Timer1 and connects the selected outputs, at level 0.
+ * @param outputs GAMMA_PWM_OC1A and/or GAMMA_PWM_OC1B
+ * @note Enable interrupts with sei() afterwards.
+ */
+void GammaPwm_Init(uint8_t outputs);
+
+/**
+ * @brief Sets a level at once, cancelling a running fade.
+ * @param channel 0 or 1
+ * @param level Perceptual brightness, 0..255
+ */
+void GammaPwm_Set(uint8_t channel, uint8_t level);
+
+/**
+ * @brief Fades linearly in perceptual brightness from the current level.
+ * @param channel 0 or 1
+ * @param level Target brightness, 0..255
+ * @param duration_ms Fade time; below 2 ms the level is set at once
+ */
+void GammaPwm_FadeTo(uint8_t channel, uint8_t level, uint16_t duration_ms);
+
+/**
+ * @brief Tells whether a fade is still running.
+ * @param channel 0 or 1
+ * @return 1 while fading, else 0
+ */
+uint8_t GammaPwm_Busy(uint8_t channel);
+
+/**
+ * @brief Compare value of a level, without a fade.
+ * @param level Perceptual brightness, 0..255
+ * @return 0..GAMMA_PWM_TOP
+ */
+uint16_t GammaPwm_Lookup(uint8_t level);
+
+#endif /* GAMMA_PWM_H */
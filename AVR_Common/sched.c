@@ -0,0 +1,162 @@
+/**
+ * @file sched.c
+ * @brief Cooperative periodic task scheduler on a 1 ms tick for the ATmega328P
+ *
+ * Timer0 overflows every 1024 us at prescaler 64. The ISR adds one
+ * millisecond per overflow and carries the extra 24 us, adding a second
+ * millisecond when they reach 1000 us, so the tick has no long term drift.
+ *
+ * Times are 16-bit and compared through a signed difference, which stays
+ * correct across the wrap for periods below 32768 ms.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#include "sched.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+
+#define SCHED_OVF_MS     1U     ///< Whole milliseconds per Timer0 overflow
+#define SCHED_OVF_FRAC  24U     ///< Remaining microseconds per overflow
+
+/** One entry of the task table */
+typedef struct
+{
+    Sched_TaskFn_t fn;
+    uint16_t period;    ///< Milliseconds between two calls
+    uint16_t due;       ///< Tick of the next call
+    uint16_t late_max;  ///< Worst start delay, milliseconds
+    uint16_t missed;    ///< Calls late by a whole period or more
+} Sched_Task_t;
+
+static Sched_Task_t sched_tasks[SCHED_MAX_TASKS];
+static uint8_t sched_count;
+
+static volatile uint16_t sched_ms;          ///< Tick counter
+static uint16_t sched_frac;                 ///< Carried microseconds, ISR only
+
+void Sched_Init(void)
+{
+    sched_count = 0U;
+    sched_ms = 0U;
+    sched_frac = 0U;
+
+    /** Keep the waveform mode, prescaler 64 */
+    TCCR0B = (uint8_t)((TCCR0B & (uint8_t)~((1 << CS02) | (1 << CS01) | (1 << CS00)))
+                       | (1 << CS01) | (1 << CS00));
+    TIFR0 = (1 << TOV0);
+    TIMSK0 |= (1 << TOIE0);
+}
+
+uint16_t Sched_Now(void)
+{
+    uint16_t now;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        now = sched_ms;
+    }
+    return now;
+}
+
+uint8_t Sched_Add(Sched_TaskFn_t fn, uint16_t period_ms, uint16_t offset_ms)
+{
+    Sched_Task_t *task;
+
+    if ((sched_count >= SCHED_MAX_TASKS) || (fn == 0) || (period_ms == 0U))
+    {
+        return SCHED_NO_TASK;
+    }
+
+    task = &sched_tasks[sched_count];
+    task->fn = fn;
+    task->period = period_ms;
+    task->due = (uint16_t)(Sched_Now() + offset_ms);
+    task->late_max = 0U;
+    task->missed = 0U;
+
+    return sched_count++;
+}
+
+void Sched_Run(void)
+{
+    Sched_Task_t *task;
+    uint16_t start, now, late;
+    uint8_t i, ran;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+    while (1)
+    {
+        ran = 0U;
+        start = Sched_Now();
+        for (i = 0U; i < sched_count; i++)
+        {
+            task = &sched_tasks[i];
+            now = Sched_Now();
+            if ((int16_t)(now - task->due) < 0)
+            {
+                continue;
+            }
+
+            late = (uint16_t)(now - task->due);
+            if (late > task->late_max)
+            {
+                task->late_max = late;
+            }
+            if (late >= task->period)
+            {
+                /** Skip the lost calls instead of bursting to catch up */
+                task->missed++;
+                task->due = now;
+            }
+            task->due = (uint16_t)(task->due + task->period);
+
+            task->fn();
+            ran = 1U;
+        }
+
+        /** Nothing ran and no tick since the pass began: sleep until the next tick */
+        if (ran == 0U)
+        {
+            cli();
+            if (sched_ms == start)
+            {
+                sleep_enable();
+                sei(); /* The instruction after sei always runs, so no tick is lost */
+                sleep_cpu();
+                sleep_disable();
+            }
+            sei();
+        }
+    }
+}
+
+uint16_t Sched_LateMax(uint8_t id)
+{
+    return (id < sched_count) ? sched_tasks[id].late_max : 0U;
+}
+
+uint16_t Sched_Missed(uint8_t id)
+{
+    return (id < sched_count) ? sched_tasks[id].missed : 0U;
+}
+
+/**
+ * @brief Timer0 overflow interrupt, advances the millisecond tick.
+ */
+ISR(TIMER0_OVF_vect)
+{
+    uint16_t ms = (uint16_t)(sched_ms + SCHED_OVF_MS);
+
+    sched_frac += SCHED_OVF_FRAC;
+    if (sched_frac >= 1000U)
+    {
+        sched_frac -= 1000U;
+        ms++;
+    }
+    sched_ms = ms;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file sched.h
+ * @brief Cooperative periodic task scheduler on a 1 ms tick for the ATmega328P
+ *
+ * Tasks are plain functions that run to completion, each with a period in
+ * milliseconds. Sched_Run() calls the tasks that are due, in the order they
+ * were added, and sleeps in idle mode until the next tick when none is due.
+ * A task must not block: long work is split over several calls.
+ *
+ * Every call records how late the task started. A task that was late by a
+ * whole period or more counts a missed deadline and is rescheduled from the
+ * current time instead of running several times in a row to catch up.
+ *
+ * The tick comes from Timer0 overflows: Sched_Init() sets the Timer0 prescaler
+ * to 64 (one overflow every 1024 us) and owns ISR(TIMER0_OVF_vect). Timer0
+ * must count 0..255, in normal or fast PWM mode, so OC0A/OC0B stay usable for
+ * PWM at 976 Hz.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+/** Size of the task table */
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS  8U
+#endif
+
+/** Returned by Sched_Add() when the table is full */
+#define SCHED_NO_TASK    0xFFU
+
+/** Task function, runs to completion */
+typedef void (*Sched_TaskFn_t)(void);
+
+/**
+ * @brief Starts the tick. Configure Timer0 PWM (TCCR0A) before or after.
+ * @note Enable interrupts with sei() afterwards.
+ */
+void Sched_Init(void);
+
+/**
+ * @brief Adds a periodic task.
+ * @param fn Task function
+ * @param period_ms Time between two calls, 1..32767
+ * @param offset_ms Delay before the first call, to spread tasks of equal period
+ * @return Task id for the statistics, or SCHED_NO_TASK
+ */
+uint8_t Sched_Add(Sched_TaskFn_t fn, uint16_t period_ms, uint16_t offset_ms);
+
+/**
+ * @brief Runs the tasks forever, sleeping between ticks when idle.
+ */
+void Sched_Run(void);
+
+/**
+ * @brief Milliseconds since Sched_Init(), wraps after 65.5 s.
+ */
+uint16_t Sched_Now(void);
+
+/**
+ * @brief Worst start delay of a task so far, in milliseconds.
+ * @param id Value returned by Sched_Add()
+ */
+uint16_t Sched_LateMax(uint8_t id);
+
+/**
+ * @brief Number of calls that started a whole period or more too late.
+ * @param id Value returned by Sched_Add()
+ */
+uint16_t Sched_Missed(uint8_t id);
+
+#endif /* SCHED_H */
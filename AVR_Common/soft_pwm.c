@@ -0,0 +1,181 @@
+/**
+ * @file soft_pwm.c
+ * @brief Bit angle modulation (BAM) software PWM for the ATmega328P
+ *
+ * The ISR owns the front set of bit planes, SoftPwm_Commit() fills the back
+ * set and requests a swap, done by the ISR between two periods so a period
+ * never mixes old and new levels.
+ *
+ * The ISR writes OCR2A before anything else: in CTC mode the register is not
+ * buffered, and the 4-count bit 0 slot must be programmed before TCNT2
+ * passes it. When another interrupt delayed the ISR so much that TCNT2 is
+ * already past the new top, the match would only come after a full wrap
+ * (512 us of bit 0); the ISR then moves the top just ahead of TCNT2, so the
+ * late slot is only stretched by the delay. The period end, with the swap,
+ * falls in a 256-count slot.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#include "soft_pwm.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/** Slot order: level bit shown and OCR2A (length - 1) of each slot */
+static const uint8_t slot_bit[SOFT_PWM_SLOTS] = {0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 7U};
+static const uint8_t slot_top[SOFT_PWM_SLOTS] = {3U, 7U, 15U, 31U, 63U, 127U, 255U, 255U, 255U};
+
+static uint8_t soft_level[SOFT_PWM_CHANNELS];
+
+/** Pin states of each port for each level bit, front and back set */
+static uint8_t soft_planes[2][8][SOFT_PWM_PORT_COUNT];
+static volatile uint8_t soft_front;         ///< Plane set shown by the ISR
+static volatile uint8_t soft_swap;          ///< Back set complete, swap at the period end
+static uint8_t soft_slot;                   ///< Slot started by the next interrupt
+static volatile uint8_t soft_ticks_max;     ///< Longest ISR, in Timer2 counts
+
+void SoftPwm_Init(void)
+{
+#define SOFT_PWM_INIT_PORT(port, ddr, mask) \
+    port &= (uint8_t)~(mask); \
+    ddr |= (mask);
+    SOFT_PWM_PORTS(SOFT_PWM_INIT_PORT)
+#undef SOFT_PWM_INIT_PORT
+#ifdef SOFT_PWM_PROFILE_PORT
+    SOFT_PWM_PROFILE_DDR |= (1 << SOFT_PWM_PROFILE_PIN);
+#endif
+
+    soft_slot = 0U;
+
+    /** CTC, 2 us per count; the first match ends a dummy 512 us slot */
+    TCCR2A = (1 << WGM21);
+    TCCR2B = 0x00;
+    TCNT2 = 0U;
+    OCR2A = slot_top[SOFT_PWM_SLOTS - 1U];
+    TIFR2 = (1 << OCF2A);
+    TIMSK2 = (1 << OCIE2A);
+    TCCR2B = (1 << CS21) | (1 << CS20); /* Prescaler = 32 */
+}
+
+void SoftPwm_Set(uint8_t channel, uint8_t level)
+{
+    if (channel < SOFT_PWM_CHANNELS)
+    {
+        soft_level[channel] = level;
+    }
+}
+
+void SoftPwm_Commit(void)
+{
+    uint8_t (*planes)[SOFT_PWM_PORT_COUNT];
+    const uint8_t *level;
+    uint8_t row, pin, b, mask;
+
+    /** Cancel a pending swap so the back set stays the back set while rebuilt */
+    soft_swap = 0U;
+    planes = soft_planes[soft_front ^ 1U];
+
+    row = 0U;
+#define SOFT_PWM_BUILD_PORT(port, ddr, pins) \
+    for (b = 0U; b < 8U; b++) \
+    { \
+        planes[b][row] = 0U; \
+    } \
+    level = &soft_level[SOFT_PWM_CHANNEL(row, 0U)]; \
+    for (pin = 0U, mask = 1U; pin < 8U; pin++, mask <<= 1) \
+    { \
+        if (((pins) & mask) != 0U) \
+        { \
+            for (b = 0U; b < 8U; b++) \
+            { \
+                if ((level[pin] & (1U << b)) != 0U) \
+                { \
+                    planes[b][row] |= mask; \
+                } \
+            } \
+        } \
+    } \
+    row++;
+    SOFT_PWM_PORTS(SOFT_PWM_BUILD_PORT)
+#undef SOFT_PWM_BUILD_PORT
+
+    soft_swap = 1U;
+}
+
+uint8_t SoftPwm_IsrTicksMax(void)
+{
+    return soft_ticks_max;
+}
+
+/**
+ * @brief Timer2 compare match A interrupt, starts the next slot.
+ */
+ISR(TIMER2_COMPA_vect)
+{
+    uint8_t slot = soft_slot;
+    uint8_t top = slot_top[slot];
+    const uint8_t *bits;
+    uint8_t now;
+    uint8_t matched;
+    uint16_t ticks;
+
+#ifdef SOFT_PWM_PROFILE_PORT
+    SOFT_PWM_PROFILE_PORT |= (1 << SOFT_PWM_PROFILE_PIN);
+#endif
+
+    OCR2A = top;
+    bits = soft_planes[soft_front][slot_bit[slot]];
+
+#define SOFT_PWM_WRITE_PORT(port, ddr, mask) \
+    port = (uint8_t)((port & (uint8_t)~(mask)) | *bits++);
+    SOFT_PWM_PORTS(SOFT_PWM_WRITE_PORT)
+#undef SOFT_PWM_WRITE_PORT
+
+    /** Past the top the match was missed; two counts ahead cannot be passed before the write */
+    now = TCNT2;
+    if ((now > top) && (now < 0xFEU))
+    {
+        top = (uint8_t)(now + 2U);
+        OCR2A = top;
+    }
+
+    slot++;
+    if (slot >= SOFT_PWM_SLOTS)
+    {
+        slot = 0U;
+        if (soft_swap != 0U)
+        {
+            soft_front ^= 1U;
+            soft_swap = 0U;
+        }
+    }
+    soft_slot = slot;
+
+    /**
+     * TCNT2 restarted from 0 at the match, so it counts the latency and the
+     * ISR. An ISR longer than its slot (bit 0 is 4 counts) saw the next match
+     * restart it once more: the flag is set again and the slot length is
+     * added. The flag is read around TCNT2 so a match between the two reads
+     * is not missed.
+     */
+    matched = TIFR2 & (1 << OCF2A);
+    ticks = TCNT2;
+    if ((matched == 0U) && ((TIFR2 & (1 << OCF2A)) != 0U))
+    {
+        matched = 1U;
+        ticks = TCNT2;
+    }
+    if (matched != 0U)
+    {
+        ticks += (uint16_t)top + 1U;
+    }
+    if (ticks > soft_ticks_max)
+    {
+        soft_ticks_max = (ticks > 0xFFU) ? 0xFFU : (uint8_t)ticks;
+    }
+
+#ifdef SOFT_PWM_PROFILE_PORT
+    SOFT_PWM_PROFILE_PORT &= (uint8_t)~(1 << SOFT_PWM_PROFILE_PIN);
+#endif
+}
@@ -0,0 +1,87 @@
+/**
+ * @file soft_pwm.h
+ * @brief Bit angle modulation (BAM) software PWM for the ATmega328P
+ *
+ * Drives 8-bit brightness on any number of port pins from one Timer2 compare
+ * interrupt. A period is split into slots, one per level bit, whose lengths
+ * are weighted 1, 2, 4 ... 128; the interrupt starting a slot writes the bit
+ * plane of that slot to every port at once. The ISR cost therefore depends on
+ * the number of ports, not on the number of channels.
+ *
+ * Timer2 runs in CTC mode at 2 us per count. Bit 0 lasts 8 us and bit 7 is
+ * split in two 512 us slots, 9 interrupts per 2040 us period (490 Hz).
+ *
+ * The ports are listed in soft_pwm_config.h, supplied by the project:
+ *
+ *   #define SOFT_PWM_PORTS(X) \
+ *       X(PORTB, DDRB, 0x08U) \
+ *       X(PORTC, DDRC, 0x3FU)
+ *
+ * Each row is X(PORT register, DDR register, mask of the pins owned by the
+ * engine). Channel numbers are SOFT_PWM_CHANNEL(row, pin): row 1 pin 2 (PC2)
+ * is channel 10. Pins outside the masks are left untouched.
+ *
+ * Defining SOFT_PWM_PROFILE_PORT, SOFT_PWM_PROFILE_DDR and SOFT_PWM_PROFILE_PIN
+ * in the same file drives that pin high for the duration of every ISR, for a
+ * scope or a simulator trace.
+ *
+ * Uses Timer2 and ISR(TIMER2_COMPA_vect).
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#ifndef SOFT_PWM_H
+#define SOFT_PWM_H
+
+#include <stdint.h>
+#include "soft_pwm_config.h"
+
+/** Channel number of pin 'pin' of the row 'row' of SOFT_PWM_PORTS */
+#define SOFT_PWM_CHANNEL(row, pin) ((uint8_t)(((row) << 3) | (pin)))
+
+#define SOFT_PWM_COUNT_PORT(port, ddr, mask) + 1U
+/** Number of rows in SOFT_PWM_PORTS */
+#define SOFT_PWM_PORT_COUNT (0U SOFT_PWM_PORTS(SOFT_PWM_COUNT_PORT))
+
+/** Number of channel numbers, including pins left out of the masks */
+#define SOFT_PWM_CHANNELS   (SOFT_PWM_PORT_COUNT * 8U)
+
+/** Timer2 interrupts per PWM period */
+#define SOFT_PWM_SLOTS      9U
+
+/** CPU cycles per Timer2 count (prescaler 32) */
+#define SOFT_PWM_TICK_CYCLES 32U
+
+/**
+ * @brief Configures the owned pins as outputs (low) and starts Timer2.
+ * @note Enable interrupts with sei() afterwards.
+ */
+void SoftPwm_Init(void);
+
+/**
+ * @brief Sets the level of one channel, applied by the next SoftPwm_Commit().
+ * @param channel SOFT_PWM_CHANNEL() number
+ * @param level 0 (off) .. 255 (always on), on for level/255 of the period
+ */
+void SoftPwm_Set(uint8_t channel, uint8_t level);
+
+/**
+ * @brief Rebuilds the bit planes from the levels and hands them to the ISR,
+ *        which switches to them at the start of the next period. Never blocks.
+ */
+void SoftPwm_Commit(void);
+
+/**
+ * @brief Worst case time from a compare match to the end of the ISR.
+ *
+ * Exact up to the end of the slot after the one the ISR started; an ISR long
+ * enough to span two more matches is under-reported. Beyond 4 counts the ISR
+ * outlasts the bit 0 slot, which is then shown for the ISR length.
+ *
+ * @return Timer2 counts, multiply by SOFT_PWM_TICK_CYCLES for CPU cycles,
+ *         saturated at 255
+ */
+uint8_t SoftPwm_IsrTicksMax(void);
+
+#endif /* SOFT_PWM_H */
@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file           : board.c
+  * @brief          : Shared NUCLEO-F446RE board setup for the FreeRTOS demos
+  ******************************************************************************
+  * @attention
+  *
+  * Only what has to exist once per image: the USART2 handle shared by the
+  * application and the UART logger (UART HAL module only), and
+  * SystemClock_Config(). After a STOP
+  * mode wakeup tickless_rtc.c restores the clock with ClockProfile_Resume().
+  *
+  ******************************************************************************
+  */
+#include "board.h"
+
+#ifdef HAL_UART_MODULE_ENABLED
+UART_HandleTypeDef huart2;
+#endif
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  /* Clock tree, voltage scale, flash wait states and caches: clock_profile.c */
+  if (ClockProfile_Apply(CLOCK_PROFILE) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
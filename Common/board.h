@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file           : board.h
+  * @brief          : Shared NUCLEO-F446RE board setup for the FreeRTOS demos
+  ******************************************************************************
+  * @attention
+  *
+  * Replaces the MX_GPIO_Init() / MX_USART2_UART_Init() copies of each demo.
+  * The init helpers are static inline and sized by the BOARD_* macros, so
+  * an application only pulls in the peripherals it calls. Define the macros
+  * before including this header to change them:
+  *
+  *   #define BOARD_LED_PINS  (GPIO_PIN_5 | GPIO_PIN_6)
+  *   #include "board.h"
+  *
+  * SystemClock_Config() and the huart2 handle live in board.c; printf()
+  * reaches the UART through the _write() in uart_log.c. The UART parts only
+  * exist when the project's CubeMX config enables the UART HAL module
+  * (HAL_UART_MODULE_ENABLED), so a demo without USART2 builds without them.
+  *
+  ******************************************************************************
+  */
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "main.h"
+#include "clock_profile.h"
+
+/* GPIOA pins driven as push-pull outputs, low at reset; 0 for none */
+#ifndef BOARD_LED_PINS
+#define BOARD_LED_PINS            GPIO_PIN_5
+#endif
+
+#ifndef BOARD_UART_BAUD
+#define BOARD_UART_BAUD           115200U
+#endif
+
+#ifdef HAL_UART_MODULE_ENABLED
+/* USART2 on PA2/PA3, routed to the ST-LINK virtual COM port */
+extern UART_HandleTypeDef huart2;
+#endif
+
+void SystemClock_Config(void);
+
+/**
+  * @brief  Enables GPIOA and configures the BOARD_LED_PINS outputs.
+  * @retval None
+  */
+static inline void Board_GpioInit(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  if (BOARD_LED_PINS != 0U)
+  {
+    HAL_GPIO_WritePin(GPIOA, BOARD_LED_PINS, GPIO_PIN_RESET);
+    GPIO_InitStruct.Pin = BOARD_LED_PINS;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+  }
+}
+
+#ifdef HAL_UART_MODULE_ENABLED
+/**
+  * @brief  Configures USART2 as 8N1 at BOARD_UART_BAUD. The divider is
+  *         computed from the current PCLK1, so call it after the clock setup.
+  * @retval None
+  */
+static inline void Board_Usart2Init(void)
+{
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = BOARD_UART_BAUD;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  if (HAL_UART_Init(&huart2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+#endif /* HAL_UART_MODULE_ENABLED */
+
+#endif /* BOARD_H */
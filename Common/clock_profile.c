@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file           : clock_profile.c
+  * @brief          : Selectable system clock profiles for the STM32F446
+  ******************************************************************************
+  * @attention
+  *
+  * Wait states follow the RM0390 table for 2.7-3.6 V (30 MHz per wait
+  * state). The regulator scale can only change while the PLL is off, which
+  * holds after reset and after STOP mode, the two places this runs from.
+  * Both PLL profiles run from HSI so no board specific HSE setup is needed.
+  *
+  * ClockProfile_Resume() is the STOP mode exit path. It runs with interrupts
+  * masked, where HAL_GetTick() stands still and the HAL RCC timeouts would
+  * never expire, so it works on the registers with bounded waits instead.
+  *
+  ******************************************************************************
+  */
+#include "clock_profile.h"
+
+/**
+  * @brief  Switches the system clock to the given profile.
+  * @param  eProfile: profile to apply
+  * @retval HAL_OK, or the status of the HAL call that failed
+  */
+HAL_StatusTypeDef ClockProfile_Apply(ClockProfile_t eProfile)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+  uint32_t ulLatency;
+  HAL_StatusTypeDef xStatus;
+
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
+  RCC_OscInitStruct.HSIState = RCC_HSI_ON;
+  RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
+                              | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+
+  __HAL_RCC_PWR_CLK_ENABLE();
+  switch (eProfile)
+  {
+    case CLOCK_PROFILE_PLL_180MHZ:
+      /* 16 MHz / 8 * 180 / 2 = 180 MHz */
+      __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+      RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+      RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+      RCC_OscInitStruct.PLL.PLLM = 8;
+      RCC_OscInitStruct.PLL.PLLN = 180;
+      RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+      RCC_OscInitStruct.PLL.PLLQ = 8;
+      RCC_OscInitStruct.PLL.PLLR = 2;
+      RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+      RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+      RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+      ulLatency = FLASH_LATENCY_5;
+      break;
+
+    case CLOCK_PROFILE_PLL_84MHZ:
+      /* 16 MHz / 16 * 336 / 4 = 84 MHz, within the VOS3 limit of 120 MHz */
+      __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
+      RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+      RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+      RCC_OscInitStruct.PLL.PLLM = 16;
+      RCC_OscInitStruct.PLL.PLLN = 336;
+      RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV4;
+      RCC_OscInitStruct.PLL.PLLQ = 7;
+      RCC_OscInitStruct.PLL.PLLR = 2;
+      RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+      RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
+      RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+      ulLatency = FLASH_LATENCY_2;
+      break;
+
+    case CLOCK_PROFILE_HSI_16MHZ:
+    default:
+      __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
+      RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+      RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+      RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+      RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+      ulLatency = FLASH_LATENCY_0;
+      break;
+  }
+
+  xStatus = HAL_RCC_OscConfig(&RCC_OscInitStruct);
+  if (xStatus != HAL_OK)
+  {
+    return xStatus;
+  }
+  if (eProfile == CLOCK_PROFILE_PLL_180MHZ)
+  {
+    /* Above 168 MHz the regulator needs over-drive, enabled once the PLL runs */
+    xStatus = HAL_PWREx_EnableOverDrive();
+    if (xStatus != HAL_OK)
+    {
+      return xStatus;
+    }
+  }
+
+  /* Raises the wait states before the switch and updates SystemCoreClock */
+  xStatus = HAL_RCC_ClockConfig(&RCC_ClkInitStruct, ulLatency);
+  if (xStatus != HAL_OK)
+  {
+    return xStatus;
+  }
+
+  __HAL_FLASH_PREFETCH_BUFFER_ENABLE();
+  __HAL_FLASH_INSTRUCTION_CACHE_ENABLE();
+  __HAL_FLASH_DATA_CACHE_ENABLE();
+  return HAL_OK;
+}
+
+/**
+  * @brief  Polls a register until the bits of ulMask read as ulValue.
+  * @param  pulReg: register to poll
+  * @param  ulMask: bits to compare
+  * @param  ulValue: expected value of those bits
+  * @retval HAL_OK, or HAL_TIMEOUT after CLOCK_PROFILE_WAIT_LOOPS reads
+  */
+static HAL_StatusTypeDef prvWaitBits(volatile uint32_t *pulReg, uint32_t ulMask, uint32_t ulValue)
+{
+  uint32_t ulLoops;
+
+  for (ulLoops = 0U; ulLoops < CLOCK_PROFILE_WAIT_LOOPS; ulLoops++)
+  {
+    if ((*pulReg & ulMask) == ulValue)
+    {
+      return HAL_OK;
+    }
+  }
+  return HAL_TIMEOUT;
+}
+
+/**
+  * @brief  Restores the profile after a STOP mode wakeup.
+  * @note   STOP mode keeps the PLL settings, bus prescalers, wait states and
+  *         voltage scale, and wakes up on HSI with the PLL and the over-drive
+  *         off. Only those are turned back on, SystemCoreClock is unchanged.
+  * @param  eProfile: profile applied before STOP mode
+  * @retval HAL_OK, or HAL_TIMEOUT if a ready flag did not come
+  */
+HAL_StatusTypeDef ClockProfile_Resume(ClockProfile_t eProfile)
+{
+  if (eProfile == CLOCK_PROFILE_HSI_16MHZ)
+  {
+    return HAL_OK;
+  }
+
+  RCC->CR |= RCC_CR_PLLON;
+  if (prvWaitBits(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY) != HAL_OK)
+  {
+    return HAL_TIMEOUT;
+  }
+
+  if ((eProfile == CLOCK_PROFILE_PLL_180MHZ) && ((PWR->CSR & PWR_CSR_ODSWRDY) == 0U))
+  {
+    PWR->CR |= PWR_CR_ODEN;
+    if (prvWaitBits(&PWR->CSR, PWR_CSR_ODRDY, PWR_CSR_ODRDY) != HAL_OK)
+    {
+      return HAL_TIMEOUT;
+    }
+    PWR->CR |= PWR_CR_ODSWEN;
+    if (prvWaitBits(&PWR->CSR, PWR_CSR_ODSWRDY, PWR_CSR_ODSWRDY) != HAL_OK)
+    {
+      return HAL_TIMEOUT;
+    }
+  }
+
+  MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, RCC_CFGR_SW_PLL);
+  return prvWaitBits(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+}
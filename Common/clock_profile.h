@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file           : clock_profile.h
+  * @brief          : Selectable system clock profiles for the STM32F446
+  ******************************************************************************
+  * @attention
+  *
+  * Each profile sets the clock tree, the regulator voltage scale, the flash
+  * wait states and the bus prescalers that go together, and turns on the
+  * flash prefetch buffer and the ART instruction and data caches.
+  *
+  * Everything derived from the clock follows without extra code as long as
+  * the profile is applied from SystemClock_Config(), before the peripherals
+  * and the scheduler start: HAL_RCC_ClockConfig() updates SystemCoreClock
+  * and re-arms the HAL time base, HAL_UART_Init() computes BRR from the
+  * current PCLK and the FreeRTOS port loads SysTick from configCPU_CLOCK_HZ
+  * (SystemCoreClock in the CubeMX FreeRTOSConfig.h).
+  *
+  ******************************************************************************
+  */
+#ifndef CLOCK_PROFILE_H
+#define CLOCK_PROFILE_H
+
+#include "main.h"
+
+typedef enum
+{
+  CLOCK_PROFILE_HSI_16MHZ = 0,  /* HSI direct, VOS3, 0 WS: lowest run current */
+  CLOCK_PROFILE_PLL_84MHZ,      /* HSI PLL, VOS3, 2 WS, APB1 42 MHz */
+  CLOCK_PROFILE_PLL_180MHZ      /* HSI PLL, VOS1 + over-drive, 5 WS, APB1 45 / APB2 90 MHz */
+} ClockProfile_t;
+
+/* Profile used by SystemClock_Config() in the demos */
+#ifndef CLOCK_PROFILE
+#define CLOCK_PROFILE             CLOCK_PROFILE_HSI_16MHZ
+#endif
+
+/* Polls of a ready flag before ClockProfile_Resume() gives up, about 25 ms at 16 MHz */
+#ifndef CLOCK_PROFILE_WAIT_LOOPS
+#define CLOCK_PROFILE_WAIT_LOOPS  100000U
+#endif
+
+HAL_StatusTypeDef ClockProfile_Apply(ClockProfile_t eProfile);
+HAL_StatusTypeDef ClockProfile_Resume(ClockProfile_t eProfile);
+
+#endif /* CLOCK_PROFILE_H */
@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file           : dlog.c
+  * @brief          : Deferred binary logging record encoder
+  ******************************************************************************
+  */
+#include "dlog.h"
+#include "uart_log.h"
+
+_Static_assert((DLOG_HEADER_SIZE + (4U * DLOG_MAX_ARGS)) <= UART_LOG_SLOT_SIZE,
+               "a DLOG record must fit in one uart_log slot");
+
+/**
+  * @brief  Encodes one record and hands it to the UART log ring.
+  * @param  fmt: format string stored in the .dlog_fmt section
+  * @param  args: raw argument words
+  * @param  nargs: number of arguments, at most DLOG_MAX_ARGS
+  * @retval None
+  */
+void DLog_Write(const char *fmt, const uint32_t *args, uint32_t nargs)
+{
+  uint8_t ucRecord[DLOG_HEADER_SIZE + (4U * DLOG_MAX_ARGS)];
+  uint32_t ulId = (uint32_t)fmt;
+  uint32_t ulLen = DLOG_HEADER_SIZE;
+  uint32_t i;
+
+  ucRecord[0] = DLOG_SYNC;
+  ucRecord[1] = (uint8_t)nargs;
+  ucRecord[2] = (uint8_t)ulId;
+  ucRecord[3] = (uint8_t)(ulId >> 8);
+  ucRecord[4] = (uint8_t)(ulId >> 16);
+  ucRecord[5] = (uint8_t)(ulId >> 24);
+  for (i = 0U; i < nargs; i++)
+  {
+    ucRecord[ulLen++] = (uint8_t)args[i];
+    ucRecord[ulLen++] = (uint8_t)(args[i] >> 8);
+    ucRecord[ulLen++] = (uint8_t)(args[i] >> 16);
+    ucRecord[ulLen++] = (uint8_t)(args[i] >> 24);
+  }
+  (void)UartLog_Write(ucRecord, (int)ulLen);
+}
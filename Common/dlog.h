@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : dlog.h
+  * @brief          : Deferred binary logging for the FreeRTOS demos
+  ******************************************************************************
+  * @attention
+  *
+  * DLOG(fmt, ...) takes the same arguments as printf(). With DLOG_BINARY set
+  * to 1 no formatting happens on target: the format string is placed in the
+  * .dlog_fmt section and the call only sends a small record holding the
+  * string address and the raw 32-bit arguments. tools/dlog_decode.py reads the
+  * strings back from the ELF file and prints the text on the host.
+  *
+  * Only 32-bit integer conversions (%d %i %u %x %X %o %c, optionally with
+  * the hh, h, l, z or t modifier) are supported in binary mode. Each argument
+  * is stored as one 32-bit word, so ll and j would truncate the value and
+  * shift every argument after it: tools/dlog_decode.py refuses such formats.
+  * A string argument cannot be decoded.
+  *
+  ******************************************************************************
+  */
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef DLOG_BINARY
+#define DLOG_BINARY       0U
+#endif
+
+/* Record layout: sync, argument count, format id (LE), arguments (LE) */
+#define DLOG_SYNC         0xD1U
+#define DLOG_HEADER_SIZE  6U
+/* A record must fit in a single uart_log slot to stay atomic */
+#define DLOG_MAX_ARGS     6U
+
+#if (DLOG_BINARY == 1U)
+#define DLOG(fmt, ...)                                                        \
+  do                                                                          \
+  {                                                                           \
+    static const char prvDlogFmt[]                                            \
+      __attribute__((section(".dlog_fmt"), used)) = fmt;                      \
+    const uint32_t prvDlogArgs[] = { 0U, ##__VA_ARGS__ };                     \
+    _Static_assert((sizeof(prvDlogArgs) / sizeof(uint32_t)) <= (DLOG_MAX_ARGS + 1U), \
+                   "too many DLOG arguments");                                \
+    DLog_Write(prvDlogFmt, &prvDlogArgs[1],                                   \
+               (sizeof(prvDlogArgs) / sizeof(uint32_t)) - 1U);                \
+  } while (0)
+#else
+#define DLOG(fmt, ...)    printf(fmt, ##__VA_ARGS__)
+#endif
+
+void DLog_Write(const char *fmt, const uint32_t *args, uint32_t nargs);
+
+#endif /* DLOG_H */
@@ -0,0 +1,254 @@
+/**
+  ******************************************************************************
+  * @file           : latency_bench.c
+  * @brief          : Inter-task latency benchmark suite
+  ******************************************************************************
+  * @attention
+  *
+  * Queue scenarios send bursts of queue-length items and then sleep for a
+  * tick, so a full queue and the receiver's backlog are part of the measured
+  * latency. Each item carries its send timestamp in its first four bytes.
+  * Give-to-wake scenarios give once per tick.
+  *
+  ******************************************************************************
+  */
+#include "latency_bench.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+#include "main.h"
+#define BENCH_NOW()       (DWT->CYCCNT)
+#define BENCH_UNIT        "cycles"
+#else
+#include <time.h>
+#define BENCH_NOW()       prvNowNs()
+#define BENCH_UNIT        "ns"
+
+/**
+  * @brief  Host timestamp, wraps every 4.29 s which is fine for deltas.
+  * @retval Monotonic time in nanoseconds, truncated to 32 bits
+  */
+static uint32_t prvNowNs(void)
+{
+  struct timespec xTs;
+
+  clock_gettime(CLOCK_MONOTONIC, &xTs);
+  return (uint32_t)(((uint64_t)xTs.tv_sec * 1000000000ULL) + (uint64_t)xTs.tv_nsec);
+}
+#endif
+
+typedef enum
+{
+  BENCH_QUEUE = 0,
+  BENCH_SEMAPHORE,
+  BENCH_NOTIFY
+} BenchKind_t;
+
+typedef struct
+{
+  BenchKind_t eKind;
+  UBaseType_t uxQueueLength;
+  UBaseType_t uxPayload;
+  int8_t cPrioOffset;            /* Receiver priority relative to the sender */
+} BenchScenario_t;
+
+static const BenchScenario_t xScenarios[] =
+{
+  { BENCH_QUEUE,      1U,  4U, 0 }, { BENCH_QUEUE,      1U,  4U, 1 }, { BENCH_QUEUE,      1U,  4U, -1 },
+  { BENCH_QUEUE,      5U,  4U, 0 }, { BENCH_QUEUE,      5U,  4U, 1 }, { BENCH_QUEUE,      5U,  4U, -1 },
+  { BENCH_QUEUE,     16U,  4U, 0 }, { BENCH_QUEUE,     16U,  4U, 1 }, { BENCH_QUEUE,     16U,  4U, -1 },
+  { BENCH_QUEUE,      5U, 16U, 0 }, { BENCH_QUEUE,      5U, 16U, 1 },
+  { BENCH_QUEUE,      5U, 64U, 0 }, { BENCH_QUEUE,      5U, 64U, 1 },
+  { BENCH_SEMAPHORE,  0U,  0U, 0 }, { BENCH_SEMAPHORE,  0U,  0U, 1 },
+  { BENCH_NOTIFY,     0U,  0U, 0 }, { BENCH_NOTIFY,     0U,  0U, 1 },
+};
+
+static const BenchScenario_t *pxCurrent;
+static QueueHandle_t xBenchQueue;
+static SemaphoreHandle_t xBenchSemaphore;
+static TaskHandle_t xControllerHandle;
+static TaskHandle_t xReceiverHandle;
+static volatile uint32_t ulGiveStamp;
+static uint32_t ulSamples[LATENCY_BENCH_SAMPLES];
+
+/**
+  * @brief  qsort comparator for the latency samples.
+  */
+static int prvCompare(const void *pvA, const void *pvB)
+{
+  uint32_t ulA = *(const uint32_t *)pvA;
+  uint32_t ulB = *(const uint32_t *)pvB;
+
+  return (ulA > ulB) - (ulA < ulB);
+}
+
+/**
+  * @brief  Sender side of every scenario.
+  * @param  pvParameters: unused, the scenario is in pxCurrent
+  * @retval None
+  */
+static void prvSenderTask(void *pvParameters)
+{
+  uint8_t ucItem[LATENCY_BENCH_MAX_PAYLOAD] = {0};
+  uint32_t ulStamp, ulSent = 0U;
+  UBaseType_t uxBurst;
+
+  (void)pvParameters;
+  for (;;)
+  {
+    if (pxCurrent->eKind == BENCH_QUEUE)
+    {
+      for (uxBurst = 0U; uxBurst < pxCurrent->uxQueueLength; uxBurst++)
+      {
+        ulStamp = BENCH_NOW();
+        memcpy(ucItem, &ulStamp, sizeof(ulStamp));
+        (void)xQueueSend(xBenchQueue, ucItem, portMAX_DELAY);
+        ulSent++;
+      }
+    }
+    else
+    {
+      ulGiveStamp = BENCH_NOW();
+      if (pxCurrent->eKind == BENCH_SEMAPHORE)
+      {
+        (void)xSemaphoreGive(xBenchSemaphore);
+      }
+      else
+      {
+        (void)xTaskNotifyGive(xReceiverHandle);
+      }
+      ulSent++;
+    }
+
+    if (ulSent >= LATENCY_BENCH_SAMPLES)
+    {
+      vTaskSuspend(NULL);
+    }
+    vTaskDelay(1);
+  }
+}
+
+/**
+  * @brief  Receiver side: timestamps the wake and collects the samples.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvReceiverTask(void *pvParameters)
+{
+  uint8_t ucItem[LATENCY_BENCH_MAX_PAYLOAD];
+  uint32_t ulStamp, ulCount = 0U;
+
+  (void)pvParameters;
+  while (ulCount < LATENCY_BENCH_SAMPLES)
+  {
+    if (pxCurrent->eKind == BENCH_QUEUE)
+    {
+      (void)xQueueReceive(xBenchQueue, ucItem, portMAX_DELAY);
+      memcpy(&ulStamp, ucItem, sizeof(ulStamp));
+    }
+    else if (pxCurrent->eKind == BENCH_SEMAPHORE)
+    {
+      (void)xSemaphoreTake(xBenchSemaphore, portMAX_DELAY);
+      ulStamp = ulGiveStamp;
+    }
+    else
+    {
+      (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      ulStamp = ulGiveStamp;
+    }
+    ulSamples[ulCount++] = BENCH_NOW() - ulStamp;
+  }
+  xTaskNotifyGive(xControllerHandle);
+  vTaskSuspend(NULL);
+}
+
+/**
+  * @brief  Prints min/avg/p99/max of the collected samples.
+  * @retval None
+  */
+static void prvReport(void)
+{
+  static const char *const pcKind[] = { "queue", "semaphore", "notify" };
+  uint64_t ullSum = 0U;
+  uint32_t i;
+
+  qsort(ulSamples, LATENCY_BENCH_SAMPLES, sizeof(uint32_t), prvCompare);
+  for (i = 0U; i < LATENCY_BENCH_SAMPLES; i++)
+  {
+    ullSum += ulSamples[i];
+  }
+  printf("%-9s len=%2u payload=%2u rx_prio=%+d  min=%lu avg=%lu p99=%lu max=%lu %s\r\n",
+         pcKind[pxCurrent->eKind], (unsigned)pxCurrent->uxQueueLength,
+         (unsigned)pxCurrent->uxPayload, (int)pxCurrent->cPrioOffset,
+         (unsigned long)ulSamples[0],
+         (unsigned long)(ullSum / LATENCY_BENCH_SAMPLES),
+         (unsigned long)ulSamples[((LATENCY_BENCH_SAMPLES * 99U) / 100U) - 1U],
+         (unsigned long)ulSamples[LATENCY_BENCH_SAMPLES - 1U], BENCH_UNIT);
+}
+
+/**
+  * @brief  Runs every scenario in turn, then deletes itself.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvControllerTask(void *pvParameters)
+{
+  TaskHandle_t xSenderHandle;
+  uint32_t i;
+
+  (void)pvParameters;
+  printf("latency bench: %u samples per scenario\r\n", (unsigned)LATENCY_BENCH_SAMPLES);
+  for (i = 0U; i < (sizeof(xScenarios) / sizeof(xScenarios[0])); i++)
+  {
+    pxCurrent = &xScenarios[i];
+    if (pxCurrent->eKind == BENCH_QUEUE)
+    {
+      xBenchQueue = xQueueCreate(pxCurrent->uxQueueLength, pxCurrent->uxPayload);
+    }
+    else if (pxCurrent->eKind == BENCH_SEMAPHORE)
+    {
+      xBenchSemaphore = xSemaphoreCreateBinary();
+    }
+
+    xTaskCreate(prvReceiverTask, "Bench Rx", LATENCY_BENCH_TASK_STACK, NULL,
+                (UBaseType_t)((int)LATENCY_BENCH_PRIORITY + pxCurrent->cPrioOffset),
+                &xReceiverHandle);
+    xTaskCreate(prvSenderTask, "Bench Tx", LATENCY_BENCH_TASK_STACK, NULL,
+                LATENCY_BENCH_PRIORITY, &xSenderHandle);
+
+    (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    vTaskDelete(xSenderHandle);
+    vTaskDelete(xReceiverHandle);
+    if (pxCurrent->eKind == BENCH_QUEUE)
+    {
+      vQueueDelete(xBenchQueue);
+    }
+    else if (pxCurrent->eKind == BENCH_SEMAPHORE)
+    {
+      vSemaphoreDelete(xBenchSemaphore);
+    }
+    prvReport();
+  }
+  printf("latency bench: done\r\n");
+  vTaskDelete(NULL);
+}
+
+/**
+  * @brief  Creates the controller task, call before vTaskStartScheduler().
+  * @retval None
+  */
+void LatencyBench_Start(void)
+{
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  /* Above the benchmark tasks so scenario setup is never interrupted */
+  xTaskCreate(prvControllerTask, "Bench Ctrl", LATENCY_BENCH_TASK_STACK + 128U, NULL,
+              LATENCY_BENCH_PRIORITY + 2U, &xControllerHandle);
+}
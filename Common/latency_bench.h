@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file           : latency_bench.h
+  * @brief          : Inter-task latency benchmark suite
+  ******************************************************************************
+  * @attention
+  *
+  * Measures the time from xQueueSend() to the return of xQueueReceive(), and
+  * from a give (binary semaphore or task notification) to the wake of the
+  * waiting task. Every scenario reports min/avg/p99/max. Timestamps are DWT
+  * cycles on Cortex-M and CLOCK_MONOTONIC nanoseconds on the POSIX port.
+  *
+  * Needs dynamic allocation and INCLUDE_vTaskDelete: each scenario creates
+  * and deletes its own tasks and queue.
+  *
+  ******************************************************************************
+  */
+#ifndef LATENCY_BENCH_H
+#define LATENCY_BENCH_H
+
+#include "FreeRTOS.h"
+
+#ifndef LATENCY_BENCH_SAMPLES
+#define LATENCY_BENCH_SAMPLES       1000U
+#endif
+
+#ifndef LATENCY_BENCH_MAX_PAYLOAD
+#define LATENCY_BENCH_MAX_PAYLOAD   64U
+#endif
+
+/* Priority of the sending task, the receiver runs one below, equal or above */
+#ifndef LATENCY_BENCH_PRIORITY
+#define LATENCY_BENCH_PRIORITY      (tskIDLE_PRIORITY + 2U)
+#endif
+
+#ifndef LATENCY_BENCH_TASK_STACK
+#define LATENCY_BENCH_TASK_STACK    (configMINIMAL_STACK_SIZE + 128U)
+#endif
+
+void LatencyBench_Start(void);
+
+#endif /* LATENCY_BENCH_H */
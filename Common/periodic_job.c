@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file           : periodic_job.c
+  * @brief          : Periodic jobs sharing one FreeRTOS dispatcher task
+  ******************************************************************************
+  */
+#include "main.h"
+#include "periodic_job.h"
+#include "rtos_static.h"
+
+static PeriodicJob_t *pxJobList;
+static TaskHandle_t xDispatcherHandle;
+RTOS_TASK_DEFINE(xDispatcherTask, PERIODIC_JOB_TASK_STACK);
+
+static void prvDispatcherTask(void *pvParameters);
+
+/**
+  * @brief  Creates the dispatcher task, jobs may be added before or after.
+  * @retval None
+  */
+void PeriodicJob_Start(void)
+{
+  if (RTOS_TASK_CREATE(xDispatcherTask, prvDispatcherTask, "Job Dispatcher", NULL,
+                       PERIODIC_JOB_TASK_PRIORITY, &xDispatcherHandle) != pdPASS)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief  Registers a job, it runs once right away and then every period.
+  * @param  pxJob: job with static storage duration
+  * @retval None
+  */
+void PeriodicJob_Add(PeriodicJob_t *pxJob)
+{
+  taskENTER_CRITICAL();
+  pxJob->xNextDue = xTaskGetTickCount();
+  pxJob->pxNext = pxJobList;
+  pxJobList = pxJob;
+  taskEXIT_CRITICAL();
+
+  if ((xDispatcherHandle != NULL) && (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED))
+  {
+    xTaskNotifyGive(xDispatcherHandle);
+  }
+}
+
+/**
+  * @brief  Runs due jobs and sleeps until the next deadline.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvDispatcherTask(void *pvParameters)
+{
+  PeriodicJob_t *pxJob;
+  TickType_t xNow, xWait, xLeft;
+
+  (void)pvParameters;
+  for (;;)
+  {
+    xNow = xTaskGetTickCount();
+    xWait = portMAX_DELAY;
+
+    for (pxJob = pxJobList; pxJob != NULL; pxJob = pxJob->pxNext)
+    {
+      if ((int32_t)(xNow - pxJob->xNextDue) >= 0)
+      {
+        pxJob->pxFn(pxJob->pvArg);
+        pxJob->xNextDue += pxJob->xPeriod;
+        /* Skip missed periods rather than running a burst to catch up */
+        if ((int32_t)(xNow - pxJob->xNextDue) >= 0)
+        {
+          pxJob->xNextDue = xNow + pxJob->xPeriod;
+        }
+      }
+      xLeft = pxJob->xNextDue - xNow;
+      if (xLeft < xWait)
+      {
+        xWait = xLeft;
+      }
+    }
+
+    /* A job added meanwhile notifies the task so the wait is recomputed */
+    (void)ulTaskNotifyTake(pdTRUE, xWait);
+  }
+}
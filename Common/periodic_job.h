@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file           : periodic_job.h
+  * @brief          : Periodic jobs sharing one FreeRTOS dispatcher task
+  ******************************************************************************
+  * @attention
+  *
+  * A job is a callback with a period. All jobs run one after the other in a
+  * single dispatcher task that sleeps until the earliest deadline, so a job
+  * costs the PeriodicJob_t below instead of a TCB and a stack. Callbacks must
+  * be short and must not block.
+  *
+  ******************************************************************************
+  */
+#ifndef PERIODIC_JOB_H
+#define PERIODIC_JOB_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef PERIODIC_JOB_TASK_STACK
+#define PERIODIC_JOB_TASK_STACK     128U
+#endif
+
+#ifndef PERIODIC_JOB_TASK_PRIORITY
+#define PERIODIC_JOB_TASK_PRIORITY  (tskIDLE_PRIORITY + 1U)
+#endif
+
+typedef void (*PeriodicJobFn_t)(void *pvArg);
+
+typedef struct PeriodicJob
+{
+  PeriodicJobFn_t pxFn;
+  void *pvArg;
+  TickType_t xPeriod;
+  TickType_t xNextDue;
+  struct PeriodicJob *pxNext;
+} PeriodicJob_t;
+
+/* Static initialiser, the job first runs when it is added */
+#define PERIODIC_JOB_INIT(fn, arg, period_ms)  { (fn), (arg), pdMS_TO_TICKS(period_ms), 0U, NULL }
+
+void PeriodicJob_Start(void);
+void PeriodicJob_Add(PeriodicJob_t *pxJob);
+
+#endif /* PERIODIC_JOB_H */
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file           : policy_queue.c
+  * @brief          : Queue send with a configurable overflow policy
+  ******************************************************************************
+  */
+#include "policy_queue.h"
+
+/**
+  * @brief  Binds a created queue to an overflow policy.
+  * @param  pxQueue: wrapper to initialise
+  * @param  xQueue: queue handle, of length 1 for QUEUE_POLICY_OVERWRITE
+  * @param  uxItemSize: item size the queue was created with, at most
+  *         POLICY_QUEUE_MAX_ITEM_SIZE for QUEUE_POLICY_DROP_OLDEST
+  * @param  ePolicy: what to do when the queue is full
+  * @param  xBlockTime: wait limit for QUEUE_POLICY_BLOCK
+  * @retval None
+  */
+void PolicyQueue_Init(PolicyQueue_t *pxQueue, QueueHandle_t xQueue, UBaseType_t uxItemSize,
+                      QueuePolicy_t ePolicy, TickType_t xBlockTime)
+{
+  /* DROP_OLDEST receives the discarded item into a fixed stack buffer */
+  configASSERT((ePolicy != QUEUE_POLICY_DROP_OLDEST) ||
+               (uxItemSize <= POLICY_QUEUE_MAX_ITEM_SIZE));
+
+  pxQueue->xQueue = xQueue;
+  pxQueue->ePolicy = ePolicy;
+  pxQueue->uxItemSize = uxItemSize;
+  pxQueue->xBlockTime = xBlockTime;
+  pxQueue->ulDropped = 0U;
+}
+
+/**
+  * @brief  Sends one item according to the queue policy.
+  * @param  pxQueue: policy queue
+  * @param  pvItem: item to copy into the queue
+  * @retval pdPASS if the new item was queued, pdFAIL if it was dropped
+  */
+BaseType_t PolicyQueue_Send(PolicyQueue_t *pxQueue, const void *pvItem)
+{
+  uint8_t ucDiscard[POLICY_QUEUE_MAX_ITEM_SIZE];
+  BaseType_t xResult;
+
+  switch (pxQueue->ePolicy)
+  {
+    case QUEUE_POLICY_OVERWRITE:
+      /* An unread value being replaced counts as a drop */
+      if (uxQueueMessagesWaiting(pxQueue->xQueue) != 0U)
+      {
+        pxQueue->ulDropped++;
+      }
+      return xQueueOverwrite(pxQueue->xQueue, pvItem);
+
+    case QUEUE_POLICY_DROP_OLDEST:
+      /* The consumer may empty the queue in between, so loop on the send */
+      while ((xResult = xQueueSend(pxQueue->xQueue, pvItem, 0)) != pdPASS)
+      {
+        if (xQueueReceive(pxQueue->xQueue, ucDiscard, 0) == pdPASS)
+        {
+          pxQueue->ulDropped++;
+        }
+      }
+      return xResult;
+
+    case QUEUE_POLICY_DROP_NEWEST:
+      xResult = xQueueSend(pxQueue->xQueue, pvItem, 0);
+      break;
+
+    case QUEUE_POLICY_BLOCK:
+    default:
+      xResult = xQueueSend(pxQueue->xQueue, pvItem, pxQueue->xBlockTime);
+      break;
+  }
+
+  if (xResult != pdPASS)
+  {
+    pxQueue->ulDropped++;
+  }
+  return xResult;
+}
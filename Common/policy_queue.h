@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file           : policy_queue.h
+  * @brief          : Queue send with a configurable overflow policy
+  ******************************************************************************
+  * @attention
+  *
+  * Wraps a FreeRTOS queue so that a producer decides up front what happens
+  * when its consumer falls behind, and counts every item lost that way:
+  *
+  *   QUEUE_POLICY_BLOCK        wait up to xBlockTime, drop the new item on timeout
+  *   QUEUE_POLICY_DROP_NEWEST  never wait, drop the new item when full
+  *   QUEUE_POLICY_DROP_OLDEST  never wait, discard the oldest item to make room
+  *   QUEUE_POLICY_OVERWRITE    xQueueOverwrite(), queue length must be 1
+  *
+  ******************************************************************************
+  */
+#ifndef POLICY_QUEUE_H
+#define POLICY_QUEUE_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* Largest item DROP_OLDEST can discard, it is read into a stack buffer;
+   PolicyQueue_Init() asserts the item size against it */
+#ifndef POLICY_QUEUE_MAX_ITEM_SIZE
+#define POLICY_QUEUE_MAX_ITEM_SIZE  16U
+#endif
+
+typedef enum
+{
+  QUEUE_POLICY_BLOCK = 0,
+  QUEUE_POLICY_DROP_NEWEST,
+  QUEUE_POLICY_DROP_OLDEST,
+  QUEUE_POLICY_OVERWRITE
+} QueuePolicy_t;
+
+typedef struct
+{
+  QueueHandle_t xQueue;
+  QueuePolicy_t ePolicy;
+  UBaseType_t uxItemSize;         /* Size the queue was created with */
+  TickType_t xBlockTime;          /* Only used by QUEUE_POLICY_BLOCK */
+  volatile uint32_t ulDropped;    /* Items lost to the policy */
+} PolicyQueue_t;
+
+void PolicyQueue_Init(PolicyQueue_t *pxQueue, QueueHandle_t xQueue, UBaseType_t uxItemSize,
+                      QueuePolicy_t ePolicy, TickType_t xBlockTime);
+BaseType_t PolicyQueue_Send(PolicyQueue_t *pxQueue, const void *pvItem);
+
+#endif /* POLICY_QUEUE_H */
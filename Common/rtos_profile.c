@@ -0,0 +1,170 @@
+/**
+  ******************************************************************************
+  * @file           : rtos_profile.c
+  * @brief          : Per-task CPU, stack and queue depth profiling
+  ******************************************************************************
+  * @attention
+  *
+  * Every RTOS_PROFILE_PERIOD_MS the profiler task samples the run time
+  * counters, stack high water marks and the depth of the registered queues,
+  * and sends one DLOG record per item:
+  *
+  *   P <window cycles>
+  *   T<task number> cpu=<permille> hwm=<free stack words>
+  *   Q<index> depth=<now> peak=<max since start>
+  *
+  * CPU load is computed from the counter deltas over the window, so the
+  * 32-bit DWT cycle counter may wrap between windows. A task name is printed
+  * once, as plain text, the first time its number is seen.
+  *
+  ******************************************************************************
+  */
+#include "main.h"
+#include "rtos_profile.h"
+#include "task.h"
+#include "dlog.h"
+#include "rtos_static.h"
+
+#if (RTOS_PROFILE_ENABLED == 1U)
+
+typedef struct
+{
+  UBaseType_t uxTaskNumber;
+  uint32_t ulLastRunTime;
+} ProfileTask_t;
+
+static TaskStatus_t xStatus[RTOS_PROFILE_MAX_TASKS];
+static ProfileTask_t xKnown[RTOS_PROFILE_MAX_TASKS];
+static UBaseType_t uxKnownCount;
+static QueueHandle_t xQueues[RTOS_PROFILE_MAX_QUEUES];
+static UBaseType_t uxQueuePeak[RTOS_PROFILE_MAX_QUEUES];
+static UBaseType_t uxQueueCount;
+RTOS_TASK_DEFINE(xProfileTask, RTOS_PROFILE_TASK_STACK);
+
+static void prvProfileTask(void *pvParameters);
+
+/**
+  * @brief  Starts the DWT cycle counter used as run time stats clock.
+  * @retval None
+  */
+void RtosProfile_TimerInit(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+  * @brief  Creates the profiler task.
+  * @retval None
+  */
+void RtosProfile_Start(void)
+{
+  if (RTOS_TASK_CREATE(xProfileTask, prvProfileTask, "Profiler", NULL,
+                       RTOS_PROFILE_TASK_PRIORITY, NULL) != pdPASS)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief  Adds a queue to the depth report.
+  * @param  xQueue: queue handle
+  * @retval None
+  */
+void RtosProfile_AddQueue(QueueHandle_t xQueue)
+{
+  if (uxQueueCount < RTOS_PROFILE_MAX_QUEUES)
+  {
+    xQueues[uxQueueCount++] = xQueue;
+  }
+}
+
+/**
+  * @brief  Finds the previous sample of a task, adding it on first sight.
+  * @param  pxStatus: current task status
+  * @retval Slot holding the previous run time, NULL if the table is full
+  */
+static ProfileTask_t *prvLookup(const TaskStatus_t *pxStatus)
+{
+  UBaseType_t i;
+
+  for (i = 0U; i < uxKnownCount; i++)
+  {
+    if (xKnown[i].uxTaskNumber == pxStatus->xTaskNumber)
+    {
+      return &xKnown[i];
+    }
+  }
+  if (uxKnownCount == RTOS_PROFILE_MAX_TASKS)
+  {
+    return NULL;
+  }
+  printf("T%u = %s\r\n", (unsigned)pxStatus->xTaskNumber, pxStatus->pcTaskName);
+  xKnown[uxKnownCount].uxTaskNumber = pxStatus->xTaskNumber;
+  xKnown[uxKnownCount].ulLastRunTime = pxStatus->ulRunTimeCounter;
+  return &xKnown[uxKnownCount++];
+}
+
+/**
+  * @brief  Profiler task: samples and reports every RTOS_PROFILE_PERIOD_MS.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvProfileTask(void *pvParameters)
+{
+  TickType_t xLastWake = xTaskGetTickCount();
+  uint32_t ulLastTotal = portGET_RUN_TIME_COUNTER_VALUE();
+  uint32_t ulTotal, ulWindow, ulDelta;
+  UBaseType_t uxCount, uxWaiting, i, j;
+  ProfileTask_t *pxPrev;
+
+  (void)pvParameters;
+  for (;;)
+  {
+    /* Queues are sampled every 10 ms of the window to catch short peaks */
+    for (i = 0U; i < (RTOS_PROFILE_PERIOD_MS / 10U); i++)
+    {
+      vTaskDelayUntil(&xLastWake, pdMS_TO_TICKS(10U));
+      for (j = 0U; j < uxQueueCount; j++)
+      {
+        uxWaiting = uxQueueMessagesWaiting(xQueues[j]);
+        if (uxWaiting > uxQueuePeak[j])
+        {
+          uxQueuePeak[j] = uxWaiting;
+        }
+      }
+    }
+
+    uxCount = uxTaskGetSystemState(xStatus, RTOS_PROFILE_MAX_TASKS, NULL);
+    ulTotal = portGET_RUN_TIME_COUNTER_VALUE();
+    ulWindow = ulTotal - ulLastTotal;
+    ulLastTotal = ulTotal;
+    if (ulWindow == 0U)
+    {
+      continue;
+    }
+
+    DLOG("P %lu\r\n", (unsigned long)ulWindow);
+    for (i = 0U; i < uxCount; i++)
+    {
+      pxPrev = prvLookup(&xStatus[i]);
+      if (pxPrev == NULL)
+      {
+        continue;
+      }
+      ulDelta = xStatus[i].ulRunTimeCounter - pxPrev->ulLastRunTime;
+      pxPrev->ulLastRunTime = xStatus[i].ulRunTimeCounter;
+      DLOG("T%u cpu=%u hwm=%u\r\n", (unsigned)xStatus[i].xTaskNumber,
+           (unsigned)(((uint64_t)ulDelta * 1000U) / ulWindow),
+           (unsigned)xStatus[i].usStackHighWaterMark);
+    }
+    for (i = 0U; i < uxQueueCount; i++)
+    {
+      DLOG("Q%u depth=%u peak=%u\r\n", (unsigned)i,
+           (unsigned)uxQueueMessagesWaiting(xQueues[i]), (unsigned)uxQueuePeak[i]);
+    }
+  }
+}
+
+#endif /* RTOS_PROFILE_ENABLED */
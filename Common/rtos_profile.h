@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : rtos_profile.h
+  * @brief          : Per-task CPU, stack and queue depth profiling
+  ******************************************************************************
+  * @attention
+  *
+  * Enabled when FreeRTOSConfig.h contains:
+  *   #define configUSE_TRACE_FACILITY                 1
+  *   #define configGENERATE_RUN_TIME_STATS            1
+  *   #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() RtosProfile_TimerInit()
+  *   #define portGET_RUN_TIME_COUNTER_VALUE()         (DWT->CYCCNT)
+  * Otherwise the calls below compile to nothing.
+  *
+  ******************************************************************************
+  */
+#ifndef RTOS_PROFILE_H
+#define RTOS_PROFILE_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#ifndef RTOS_PROFILE_PERIOD_MS
+#define RTOS_PROFILE_PERIOD_MS      2000U
+#endif
+
+#ifndef RTOS_PROFILE_MAX_TASKS
+#define RTOS_PROFILE_MAX_TASKS      8U
+#endif
+
+#ifndef RTOS_PROFILE_MAX_QUEUES
+#define RTOS_PROFILE_MAX_QUEUES     4U
+#endif
+
+#ifndef RTOS_PROFILE_TASK_STACK
+#define RTOS_PROFILE_TASK_STACK     160U
+#endif
+
+#ifndef RTOS_PROFILE_TASK_PRIORITY
+#define RTOS_PROFILE_TASK_PRIORITY  (tskIDLE_PRIORITY + 1U)
+#endif
+
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+#define RTOS_PROFILE_ENABLED        1U
+void RtosProfile_TimerInit(void);
+void RtosProfile_Start(void);
+void RtosProfile_AddQueue(QueueHandle_t xQueue);
+#else
+#define RTOS_PROFILE_ENABLED        0U
+#define RtosProfile_Start()         ((void)0)
+#define RtosProfile_AddQueue(q)     ((void)(q))
+#endif
+
+#endif /* RTOS_PROFILE_H */
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file           : rtos_static.c
+  * @brief          : Idle and timer task memory for static allocation
+  ******************************************************************************
+  */
+#include "rtos_static.h"
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+
+static StaticTask_t xIdleTaskTcb;
+static StackType_t xIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+/**
+  * @brief  Provides the idle task memory, required by static allocation.
+  * @retval None
+  */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+  *ppxIdleTaskTCBBuffer = &xIdleTaskTcb;
+  *ppxIdleTaskStackBuffer = xIdleTaskStack;
+  *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#if (configUSE_TIMERS == 1)
+static StaticTask_t xTimerTaskTcb;
+static StackType_t xTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+/**
+  * @brief  Provides the timer service task memory.
+  * @retval None
+  */
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+  *ppxTimerTaskTCBBuffer = &xTimerTaskTcb;
+  *ppxTimerTaskStackBuffer = xTimerTaskStack;
+  *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif /* configUSE_TIMERS */
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
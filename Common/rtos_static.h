@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @file           : rtos_static.h
+  * @brief          : Kernel object creation that follows the allocation mode
+  ******************************************************************************
+  * @attention
+  *
+  * With configSUPPORT_STATIC_ALLOCATION set to 1 the *_DEFINE macros reserve
+  * the stack, control block or storage area as static arrays and the
+  * *_CREATE macros call the xxxCreateStatic() functions, so no object comes
+  * from the FreeRTOS heap and the RAM use is known at link time. Otherwise
+  * the same code uses the heap based functions.
+  *
+  *   RTOS_TASK_DEFINE(xSender, 128);
+  *   RTOS_TASK_CREATE(xSender, vSenderTask, "Sender Task", NULL, 1, &xHandle);
+  *
+  * *_DEFINE must be used at file scope, once per object. RTOS_TASK_ARRAY_*
+  * does the same for a pool of tasks that share one entry function:
+  *
+  *   RTOS_TASK_ARRAY_DEFINE(xWorker, 4, 128);
+  *   RTOS_TASK_ARRAY_CREATE(xWorker, i, vWorkerTask, "Worker", (void *)i, 1, NULL);
+  *
+  ******************************************************************************
+  */
+#ifndef RTOS_STATIC_H
+#define RTOS_STATIC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+
+/**
+  * @brief  Copies a created task handle out and turns it into a status.
+  * @param  xHandle: handle returned by the create call
+  * @param  pxOut: where to store the handle, may be NULL
+  * @retval pdPASS on success, pdFAIL otherwise
+  */
+static inline BaseType_t xRtosTaskCreated(TaskHandle_t xHandle, TaskHandle_t *pxOut)
+{
+  if (pxOut != NULL)
+  {
+    *pxOut = xHandle;
+  }
+  return (xHandle != NULL) ? pdPASS : pdFAIL;
+}
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+
+#define RTOS_TASK_DEFINE(name, depth)                                         \
+  static StackType_t name##Stack[(depth)];                                    \
+  static StaticTask_t name##Tcb
+
+#define RTOS_TASK_CREATE(name, fn, label, param, prio, phandle)               \
+  xRtosTaskCreated(xTaskCreateStatic((fn), (label),                           \
+                                     sizeof(name##Stack) / sizeof(StackType_t), \
+                                     (param), (prio), name##Stack, &name##Tcb), \
+                   (phandle))
+
+#define RTOS_TASK_ARRAY_DEFINE(name, count, depth)                            \
+  static StackType_t name##Stack[(count)][(depth)];                           \
+  static StaticTask_t name##Tcb[(count)]
+
+#define RTOS_TASK_ARRAY_CREATE(name, index, fn, label, param, prio, phandle)  \
+  xRtosTaskCreated(xTaskCreateStatic((fn), (label),                           \
+                                     sizeof(name##Stack[0]) / sizeof(StackType_t), \
+                                     (param), (prio), name##Stack[(index)],   \
+                                     &name##Tcb[(index)]),                    \
+                   (phandle))
+
+#define RTOS_QUEUE_DEFINE(name, length, itemsize)                             \
+  enum { name##Length = (length), name##ItemSize = (itemsize) };              \
+  static uint8_t name##Storage[(length) * (itemsize)];                        \
+  static StaticQueue_t name##Buffer
+
+#define RTOS_QUEUE_CREATE(name)                                               \
+  xQueueCreateStatic(name##Length, name##ItemSize, name##Storage, &name##Buffer)
+
+#define RTOS_BINARY_SEMAPHORE_DEFINE(name)                                    \
+  static StaticSemaphore_t name##Buffer
+
+#define RTOS_BINARY_SEMAPHORE_CREATE(name)                                    \
+  xSemaphoreCreateBinaryStatic(&name##Buffer)
+
+#define RTOS_EVENT_GROUP_DEFINE(name)                                         \
+  static StaticEventGroup_t name##Buffer
+
+#define RTOS_EVENT_GROUP_CREATE(name)                                         \
+  xEventGroupCreateStatic(&name##Buffer)
+
+#define RTOS_STREAM_BUFFER_DEFINE(name, size, trigger)                        \
+  enum { name##Size = (size), name##Trigger = (trigger) };                    \
+  static uint8_t name##Storage[(size) + 1];                                   \
+  static StaticStreamBuffer_t name##Buffer
+
+#define RTOS_STREAM_BUFFER_CREATE(name)                                       \
+  xStreamBufferCreateStatic(name##Size, name##Trigger, name##Storage, &name##Buffer)
+
+#else
+
+#define RTOS_TASK_DEFINE(name, depth)                                         \
+  enum { name##Depth = (depth) }
+
+#define RTOS_TASK_CREATE(name, fn, label, param, prio, phandle)               \
+  xTaskCreate((fn), (label), name##Depth, (param), (prio), (phandle))
+
+#define RTOS_TASK_ARRAY_DEFINE(name, count, depth)                            \
+  enum { name##Depth = (depth) }
+
+#define RTOS_TASK_ARRAY_CREATE(name, index, fn, label, param, prio, phandle)  \
+  xTaskCreate((fn), (label), name##Depth, (param), (prio), (phandle))
+
+#define RTOS_QUEUE_DEFINE(name, length, itemsize)                             \
+  enum { name##Length = (length), name##ItemSize = (itemsize) }
+
+#define RTOS_QUEUE_CREATE(name)                                               \
+  xQueueCreate(name##Length, name##ItemSize)
+
+#define RTOS_BINARY_SEMAPHORE_DEFINE(name)                                    \
+  enum { name##Unused }
+
+#define RTOS_BINARY_SEMAPHORE_CREATE(name)                                    \
+  xSemaphoreCreateBinary()
+
+#define RTOS_EVENT_GROUP_DEFINE(name)                                         \
+  enum { name##Unused }
+
+#define RTOS_EVENT_GROUP_CREATE(name)                                         \
+  xEventGroupCreate()
+
+#define RTOS_STREAM_BUFFER_DEFINE(name, size, trigger)                        \
+  enum { name##Size = (size), name##Trigger = (trigger) }
+
+#define RTOS_STREAM_BUFFER_CREATE(name)                                       \
+  xStreamBufferCreate(name##Size, name##Trigger)
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
+#endif /* RTOS_STATIC_H */
@@ -0,0 +1,239 @@
+/**
+  ******************************************************************************
+  * @file           : tickless_rtc.c
+  * @brief          : RTC backed tickless idle with STOP mode for FreeRTOS
+  ******************************************************************************
+  * @attention
+  *
+  * The idle time is programmed in the RTC wakeup timer and the core enters
+  * STOP mode. On wakeup the time really spent asleep is measured with the RTC
+  * calendar subseconds, so an early wakeup from another interrupt still steps
+  * the kernel tick by the right amount. The fraction of a tick left over is
+  * carried to the next sleep, keeping the tick count locked to the RTC.
+  *
+  * The sleep path runs with interrupts masked, so HAL_GetTick() stands still
+  * and no HAL call with a timeout may be used there: the wakeup timer is
+  * programmed through the RTC registers and the clock is restored with
+  * ClockProfile_Resume(), both with bounded waits.
+  *
+  ******************************************************************************
+  */
+#include "tickless_rtc.h"
+#include "clock_profile.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (configUSE_TICKLESS_IDLE == 2)
+
+/* Longest sleep the 16-bit wakeup counter allows */
+#define MAX_SUPPRESSED_TICKS  ((TickType_t)((0x10000ULL * configTICK_RATE_HZ) / TICKLESS_WUT_HZ))
+
+static RTC_HandleTypeDef hrtc;
+static TicklessStats_t xStats;
+static uint32_t ulResidual;   /* Subsecond units * configTICK_RATE_HZ not yet stepped */
+
+/**
+  * @brief  Position inside the current hour in 1/4096 s units.
+  * @note   Shadow registers are bypassed, so read until two samples agree.
+  * @retval RTC time stamp
+  */
+static uint32_t prvRtcNow(void)
+{
+  uint32_t ulSsr, ulTr;
+
+  do
+  {
+    ulSsr = hrtc.Instance->SSR;
+    ulTr = hrtc.Instance->TR;
+  } while ((ulSsr != hrtc.Instance->SSR) || (ulTr != hrtc.Instance->TR));
+
+  return ((((((ulTr >> 12) & 0x7U) * 10U) + ((ulTr >> 8) & 0xFU)) * 60U
+          + ((((ulTr >> 4) & 0x7U) * 10U) + (ulTr & 0xFU))) * TICKLESS_RTC_SUBSEC_HZ)
+         + (TICKLESS_RTC_PREDIV_S - (ulSsr & 0xFFFFU));
+}
+
+/**
+  * @brief  Starts the wakeup timer interrupt after ulCounts RTCCLK / 16 periods.
+  * @note   Register level, the HAL version waits on HAL_GetTick().
+  * @param  ulCounts: 1 .. 0x10000
+  * @retval HAL_OK, or HAL_TIMEOUT if the timer could not be written
+  */
+static HAL_StatusTypeDef prvWakeUpTimerStart(uint32_t ulCounts)
+{
+  uint32_t ulLoops;
+
+  __HAL_RTC_WRITEPROTECTION_DISABLE(&hrtc);
+  __HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);
+  for (ulLoops = 0U; __HAL_RTC_WAKEUPTIMER_GET_FLAG(&hrtc, RTC_FLAG_WUTWF) == 0U; ulLoops++)
+  {
+    if (ulLoops >= TICKLESS_WUT_WAIT_LOOPS)
+    {
+      __HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+      return HAL_TIMEOUT;
+    }
+  }
+
+  hrtc.Instance->WUTR = ulCounts - 1U;
+  MODIFY_REG(hrtc.Instance->CR, RTC_CR_WUCKSEL, RTC_WAKEUPCLOCK_RTCCLK_DIV16);
+  __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&hrtc, RTC_FLAG_WUTF);
+  __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG();
+  __HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_IT();
+  __HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_RISING_EDGE();
+  __HAL_RTC_WAKEUPTIMER_ENABLE_IT(&hrtc, RTC_IT_WUT);
+  __HAL_RTC_WAKEUPTIMER_ENABLE(&hrtc);
+  __HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Stops the wakeup timer and clears its flags, register level.
+  * @retval None
+  */
+static void prvWakeUpTimerStop(void)
+{
+  __HAL_RTC_WRITEPROTECTION_DISABLE(&hrtc);
+  __HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);
+  __HAL_RTC_WAKEUPTIMER_DISABLE_IT(&hrtc, RTC_IT_WUT);
+  __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&hrtc, RTC_FLAG_WUTF);
+  __HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+  __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG();
+}
+
+/**
+  * @brief  Starts the RTC clock and calendar used as the STOP mode time base.
+  * @retval None
+  */
+void Tickless_Init(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+
+  HAL_PWR_EnableBkUpAccess();
+#if (TICKLESS_RTC_USE_LSE == 1U)
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSE;
+  RCC_OscInitStruct.LSEState = RCC_LSE_ON;
+  PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSE;
+#else
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+  RCC_OscInitStruct.LSIState = RCC_LSI_ON;
+  PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSI;
+#endif
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_RTC;
+  if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  __HAL_RCC_RTC_ENABLE();
+
+  hrtc.Instance = RTC;
+  hrtc.Init.HourFormat = RTC_HOURFORMAT_24;
+  hrtc.Init.AsynchPrediv = TICKLESS_RTC_PREDIV_A;
+  hrtc.Init.SynchPrediv = TICKLESS_RTC_PREDIV_S;
+  hrtc.Init.OutPut = RTC_OUTPUT_DISABLE;
+  hrtc.Init.OutPutPolarity = RTC_OUTPUT_POLARITY_HIGH;
+  hrtc.Init.OutPutType = RTC_OUTPUT_TYPE_OPENDRAIN;
+  if (HAL_RTC_Init(&hrtc) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* Calendar registers are read right after STOP, skip the APB resync */
+  HAL_RTCEx_EnableBypassShadow(&hrtc);
+
+  HAL_NVIC_SetPriority(RTC_WKUP_IRQn, TICKLESS_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+}
+
+/**
+  * @brief  Copies the sleep statistics, used to check the wake accuracy.
+  * @param  pxStats: destination
+  * @retval None
+  */
+void Tickless_GetStats(TicklessStats_t *pxStats)
+{
+  taskENTER_CRITICAL();
+  *pxStats = xStats;
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Kernel hook: sleeps in STOP mode for up to xExpectedIdleTime ticks.
+  * @param  xExpectedIdleTime: ticks until the next task is due
+  * @retval None
+  */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+  uint32_t ulStart, ulWutCounts;
+  TickType_t xSlept;
+
+  if (xExpectedIdleTime > MAX_SUPPRESSED_TICKS)
+  {
+    xExpectedIdleTime = MAX_SUPPRESSED_TICKS;
+  }
+
+  __disable_irq();
+  __DSB();
+  __ISB();
+
+  if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+  {
+    __enable_irq();
+    return;
+  }
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  HAL_SuspendTick();
+
+  ulWutCounts = (uint32_t)(((uint64_t)xExpectedIdleTime * TICKLESS_WUT_HZ) / configTICK_RATE_HZ);
+  ulStart = prvRtcNow();
+  if ((ulWutCounts == 0U) || (prvWakeUpTimerStart(ulWutCounts) != HAL_OK))
+  {
+    /* No timer to wake up from: stay on the tick for this idle period */
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    HAL_ResumeTick();
+    __enable_irq();
+    return;
+  }
+
+  /* Interrupts stay masked: WFI still wakes on a pending IRQ */
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+  /* STOP mode falls back to HSI, restore the profile the clock tree ran */
+  if (ClockProfile_Resume(CLOCK_PROFILE) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  prvWakeUpTimerStop();
+
+  xSlept = (TickType_t)TicklessStep_Ticks(ulStart, prvRtcNow(), configTICK_RATE_HZ,
+                                          (uint32_t)xExpectedIdleTime, &ulResidual);
+
+  xStats.ulSleeps++;
+  xStats.ulTicksRequested += xExpectedIdleTime;
+  xStats.ulTicksSlept += xSlept;
+  if (xSlept < xExpectedIdleTime)
+  {
+    xStats.ulEarlyWakes++;
+  }
+  vTaskStepTick(xSlept);
+
+  SysTick->VAL = 0U;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  HAL_ResumeTick();
+  __enable_irq();
+}
+
+/**
+  * @brief  RTC wakeup timer interrupt through EXTI line 22.
+  * @retval None
+  */
+void RTC_WKUP_IRQHandler(void)
+{
+  HAL_RTCEx_WakeUpTimerIRQHandler(&hrtc);
+}
+
+#endif /* configUSE_TICKLESS_IDLE == 2 */
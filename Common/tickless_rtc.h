@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file           : tickless_rtc.h
+  * @brief          : RTC backed tickless idle with STOP mode for FreeRTOS
+  ******************************************************************************
+  * @attention
+  *
+  * Requires configUSE_TICKLESS_IDLE set to 2 in FreeRTOSConfig.h so that the
+  * kernel calls the vPortSuppressTicksAndSleep() provided here instead of the
+  * default SysTick implementation. The STM32F446 has no LPTIM, so the RTC
+  * wakeup timer is the only timer that keeps running in STOP mode.
+  *
+  ******************************************************************************
+  */
+#ifndef TICKLESS_RTC_H
+#define TICKLESS_RTC_H
+
+#include "main.h"
+#include "tickless_step.h"
+#include <stdint.h>
+
+/* RTC clock: LSE crystal (Nucleo X2) or the less accurate internal LSI */
+#ifndef TICKLESS_RTC_USE_LSE
+#define TICKLESS_RTC_USE_LSE      1U
+#endif
+
+/* The wakeup timer runs from RTCCLK / 16 */
+#define TICKLESS_WUT_HZ           (32768U / 16U)
+
+#define TICKLESS_IRQ_PRIORITY     15U
+
+/* Polls of the wakeup timer write flag before a sleep is given up */
+#ifndef TICKLESS_WUT_WAIT_LOOPS
+#define TICKLESS_WUT_WAIT_LOOPS   10000U
+#endif
+
+typedef struct
+{
+  uint32_t ulSleeps;          /* STOP mode entries */
+  uint32_t ulEarlyWakes;      /* Woken by another interrupt before the timer */
+  uint32_t ulTicksRequested;  /* Sum of expected idle times */
+  uint32_t ulTicksSlept;      /* Sum of ticks actually stepped */
+} TicklessStats_t;
+
+void Tickless_Init(void);
+void Tickless_GetStats(TicklessStats_t *pxStats);
+
+#endif /* TICKLESS_RTC_H */
@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : tickless_step.h
+  * @brief          : RTC time to kernel tick conversion for tickless_rtc.c
+  ******************************************************************************
+  * @attention
+  *
+  * Free of HAL and kernel headers so the carry arithmetic can be tested on
+  * the host: Latency_Bench/Makefile, target test-tickless.
+  *
+  ******************************************************************************
+  */
+#ifndef TICKLESS_STEP_H
+#define TICKLESS_STEP_H
+
+#include <stdint.h>
+
+/* ck_spre = 32768 / (7 + 1) / (4095 + 1) = 1 Hz, subseconds in 1/4096 s */
+#define TICKLESS_RTC_PREDIV_A     7U
+#define TICKLESS_RTC_PREDIV_S     4095U
+#define TICKLESS_RTC_SUBSEC_HZ    (TICKLESS_RTC_PREDIV_S + 1U)
+
+/* One hour of subseconds, the calendar position wraps at that */
+#define TICKLESS_RTC_UNITS_PER_HOUR  (3600UL * TICKLESS_RTC_SUBSEC_HZ)
+
+/**
+  * @brief  Converts the RTC time spent asleep into whole kernel ticks.
+  * @note   The fraction of a tick left over is kept in *pulResidual, in
+  *         subsecond units times ulTickHz, and counted by the next call, so
+  *         the steps add up to the RTC time. Time beyond ulMaxTicks is
+  *         dropped: the kernel cannot step past the next task wakeup.
+  * @param  ulStart: RTC position before the sleep, 0 .. UNITS_PER_HOUR - 1
+  * @param  ulEnd: RTC position after the sleep, may have wrapped at the hour
+  * @param  ulTickHz: configTICK_RATE_HZ
+  * @param  ulMaxTicks: expected idle time, the most the tick may step
+  * @param  pulResidual: carried remainder, below TICKLESS_RTC_SUBSEC_HZ
+  * @retval Ticks to pass to vTaskStepTick()
+  */
+static inline uint32_t TicklessStep_Ticks(uint32_t ulStart, uint32_t ulEnd, uint32_t ulTickHz,
+                                          uint32_t ulMaxTicks, uint32_t *pulResidual)
+{
+  uint32_t ulUnits, ulTicks;
+
+  /* At most one 32 s sleep of units, times the tick rate, fits in 32 bits */
+  ulUnits = (ulEnd + TICKLESS_RTC_UNITS_PER_HOUR - ulStart) % TICKLESS_RTC_UNITS_PER_HOUR;
+  *pulResidual += ulUnits * ulTickHz;
+  ulTicks = *pulResidual / TICKLESS_RTC_SUBSEC_HZ;
+  *pulResidual %= TICKLESS_RTC_SUBSEC_HZ;
+  if (ulTicks > ulMaxTicks)
+  {
+    ulTicks = ulMaxTicks;
+  }
+  return ulTicks;
+}
+
+#endif /* TICKLESS_STEP_H */
@@ -0,0 +1,315 @@
+/**
+  ******************************************************************************
+  * @file           : uart_log.c
+  * @brief          : Non-blocking DMA UART log backend
+  ******************************************************************************
+  * @attention
+  *
+  * The ring is a bounded multi-producer queue of fixed size slots. Each slot
+  * carries a sequence number: a producer claims a slot with a compare-and-swap
+  * on the enqueue position, fills it and publishes it by advancing the slot
+  * sequence. No producer ever waits on another one, so the ring can be used
+  * from any task or interrupt. When the ring is full the data is dropped and
+  * counted instead of blocking the caller. A write longer than one slot claims
+  * all the slots it needs with a single compare-and-swap, so its bytes stay
+  * contiguous in the output and a full ring drops whole writes only.
+  *
+  ******************************************************************************
+  */
+#include "uart_log.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_static.h"
+#include <string.h>
+
+#define LOG_EVT_DATA        (1UL << 0)
+#define LOG_EVT_TX_DONE     (1UL << 1)
+
+typedef struct
+{
+  volatile uint32_t seq;
+  uint8_t len;
+  uint8_t data[UART_LOG_SLOT_SIZE];
+} UartLogSlot_t;
+
+static UartLogSlot_t xSlots[UART_LOG_SLOTS];
+static volatile uint32_t ulEnqueuePos;
+static uint32_t ulDequeuePos;                 /* Only touched by the logger task */
+static volatile uint32_t ulDropped;
+static uint8_t ucDmaBuf[UART_LOG_DMA_BUF_SIZE];
+static UART_HandleTypeDef *pxLogUart;
+static DMA_HandleTypeDef hdma_log_tx;
+static TaskHandle_t xLogTaskHandle;
+RTOS_TASK_DEFINE(xLogTask, UART_LOG_TASK_STACK);
+
+static void prvLogTask(void *pvParameters);
+
+/**
+  * @brief  Claims ulSlots consecutive slots at once and copies a message in.
+  * @note   The consumer frees slots in order, so the last slot being free
+  *         means the whole run is. One compare-and-swap moves the enqueue
+  *         position past the run: a message never interleaves with another
+  *         writer and is either stored whole or not at all.
+  * @param  data: bytes to store
+  * @param  len: number of bytes, at most ulSlots * UART_LOG_SLOT_SIZE
+  * @param  ulSlots: slots needed, 1 .. UART_LOG_SLOTS
+  * @retval pdPASS if stored, pdFAIL if the ring has no room for the run
+  */
+static BaseType_t prvSlotsPush(const uint8_t *data, uint32_t len, uint32_t ulSlots)
+{
+  UartLogSlot_t *pxSlot;
+  uint32_t ulPos = __atomic_load_n(&ulEnqueuePos, __ATOMIC_RELAXED);
+  uint32_t ulLast;
+  uint32_t ulChunk;
+  uint32_t i;
+  int32_t lDiff;
+
+  for (;;)
+  {
+    ulLast = ulPos + ulSlots - 1U;
+    pxSlot = &xSlots[ulLast & (UART_LOG_SLOTS - 1U)];
+    lDiff = (int32_t)(__atomic_load_n(&pxSlot->seq, __ATOMIC_ACQUIRE) - ulLast);
+    if (lDiff == 0)
+    {
+      /* On failure ulPos is reloaded with the current enqueue position */
+      if (__atomic_compare_exchange_n(&ulEnqueuePos, &ulPos, ulPos + ulSlots, 1,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        break;
+      }
+    }
+    else if (lDiff < 0)
+    {
+      return pdFAIL;
+    }
+    else
+    {
+      ulPos = __atomic_load_n(&ulEnqueuePos, __ATOMIC_RELAXED);
+    }
+  }
+
+  for (i = 0U; i < ulSlots; i++)
+  {
+    pxSlot = &xSlots[(ulPos + i) & (UART_LOG_SLOTS - 1U)];
+    ulChunk = (len > UART_LOG_SLOT_SIZE) ? UART_LOG_SLOT_SIZE : len;
+    memcpy(pxSlot->data, data, ulChunk);
+    pxSlot->len = (uint8_t)ulChunk;
+    __atomic_store_n(&pxSlot->seq, ulPos + i + 1U, __ATOMIC_RELEASE);
+    data += ulChunk;
+    len -= ulChunk;
+  }
+  return pdPASS;
+}
+
+/**
+  * @brief  Moves published slots into the DMA buffer.
+  * @retval Number of bytes placed in ucDmaBuf
+  */
+static uint32_t prvDrain(void)
+{
+  UartLogSlot_t *pxSlot;
+  uint32_t ulLen = 0U;
+
+  for (;;)
+  {
+    pxSlot = &xSlots[ulDequeuePos & (UART_LOG_SLOTS - 1U)];
+    if (__atomic_load_n(&pxSlot->seq, __ATOMIC_ACQUIRE) != (ulDequeuePos + 1U))
+    {
+      break;
+    }
+    if ((ulLen + pxSlot->len) > sizeof(ucDmaBuf))
+    {
+      break;
+    }
+    memcpy(&ucDmaBuf[ulLen], pxSlot->data, pxSlot->len);
+    ulLen += pxSlot->len;
+    __atomic_store_n(&pxSlot->seq, ulDequeuePos + UART_LOG_SLOTS, __ATOMIC_RELEASE);
+    ulDequeuePos++;
+  }
+  return ulLen;
+}
+
+/**
+  * @brief  Wakes the logger task from task or interrupt context.
+  * @retval None
+  */
+static void prvKickLogger(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  if (__get_IPSR() != 0U)
+  {
+    xTaskNotifyFromISR(xLogTaskHandle, LOG_EVT_DATA, eSetBits, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
+  else
+  {
+    xTaskNotify(xLogTaskHandle, LOG_EVT_DATA, eSetBits);
+  }
+}
+
+/**
+  * @brief  Attaches the TX DMA stream to the UART and creates the logger task.
+  * @param  huart: UART already initialised with HAL_UART_Init()
+  * @retval None
+  */
+void UartLog_Init(UART_HandleTypeDef *huart)
+{
+  uint32_t i;
+
+  for (i = 0U; i < UART_LOG_SLOTS; i++)
+  {
+    xSlots[i].seq = i;
+  }
+
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  hdma_log_tx.Instance = UART_LOG_DMA_STREAM;
+  hdma_log_tx.Init.Channel = UART_LOG_DMA_CHANNEL;
+  hdma_log_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma_log_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_log_tx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_log_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_log_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_log_tx.Init.Mode = DMA_NORMAL;
+  hdma_log_tx.Init.Priority = DMA_PRIORITY_LOW;
+  hdma_log_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+  if (HAL_DMA_Init(&hdma_log_tx) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  __HAL_LINKDMA(huart, hdmatx, hdma_log_tx);
+
+  HAL_NVIC_SetPriority(UART_LOG_DMA_IRQn, UART_LOG_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(UART_LOG_DMA_IRQn);
+  HAL_NVIC_SetPriority(UART_LOG_UART_IRQn, UART_LOG_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(UART_LOG_UART_IRQn);
+
+  if (RTOS_TASK_CREATE(xLogTask, prvLogTask, "Logger Task", NULL,
+                       UART_LOG_TASK_PRIORITY, &xLogTaskHandle) != pdPASS)
+  {
+    Error_Handler();
+  }
+  pxLogUart = huart;
+}
+
+/**
+  * @brief  Queues bytes for transmission without blocking.
+  * @note   Falls back to a polled transmit until the scheduler is running.
+  * @param  data: bytes to send
+  * @param  len: number of bytes
+  * @note   A write is queued whole or dropped whole, never cut short.
+  * @retval len, a dropped write is counted in UartLog_Dropped()
+  */
+int UartLog_Write(const uint8_t *data, int len)
+{
+  uint32_t ulSlots;
+
+  if ((pxLogUart == NULL) || (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED))
+  {
+    if (pxLogUart != NULL)
+    {
+      HAL_UART_Transmit(pxLogUart, (uint8_t *)data, (uint16_t)len, HAL_MAX_DELAY);
+    }
+    return len;
+  }
+  if (len <= 0)
+  {
+    return len;
+  }
+
+  ulSlots = ((uint32_t)len + UART_LOG_SLOT_SIZE - 1U) / UART_LOG_SLOT_SIZE;
+  if ((ulSlots > UART_LOG_SLOTS) || (prvSlotsPush(data, (uint32_t)len, ulSlots) != pdPASS))
+  {
+    __atomic_fetch_add(&ulDropped, (uint32_t)len, __ATOMIC_RELAXED);
+    return len;
+  }
+  prvKickLogger();
+  return len;
+}
+
+/**
+  * @brief  Number of bytes discarded because the ring was full.
+  * @retval Dropped byte count since reset
+  */
+uint32_t UartLog_Dropped(void)
+{
+  return ulDropped;
+}
+
+/**
+  * @brief  Logger task: drains the ring and sends it in DMA bursts.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvLogTask(void *pvParameters)
+{
+  uint32_t ulBits;
+  uint32_t ulLen;
+
+  (void)pvParameters;
+  for (;;)
+  {
+    xTaskNotifyWait(0U, LOG_EVT_DATA, &ulBits, portMAX_DELAY);
+
+    while ((ulLen = prvDrain()) > 0U)
+    {
+      if (HAL_UART_Transmit_DMA(pxLogUart, ucDmaBuf, (uint16_t)ulLen) != HAL_OK)
+      {
+        __atomic_fetch_add(&ulDropped, ulLen, __ATOMIC_RELAXED);
+        continue;
+      }
+      /* New data notifications only set LOG_EVT_DATA, keep waiting for TX */
+      do
+      {
+        xTaskNotifyWait(0U, LOG_EVT_TX_DONE, &ulBits, portMAX_DELAY);
+      } while ((ulBits & LOG_EVT_TX_DONE) == 0U);
+    }
+  }
+}
+
+/**
+  * @brief  Tx Transfer completed callback, releases the logger task.
+  * @param  huart: UART handle
+  * @retval None
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  if (huart == pxLogUart)
+  {
+    xTaskNotifyFromISR(xLogTaskHandle, LOG_EVT_TX_DONE, eSetBits, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
+}
+
+/**
+  * @brief  DMA stream interrupt used by the log transmitter.
+  * @retval None
+  */
+void UART_LOG_DMA_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_log_tx);
+}
+
+/**
+  * @brief  newlib hook behind printf(), queues the text for the logger task.
+  * @param  file: stream, stdout and stderr both go to the UART
+  * @param  data: bytes to send
+  * @param  len: number of bytes
+  * @retval Number of bytes accepted
+  */
+int _write(int file, char *data, int len)
+{
+  (void)file;
+  return UartLog_Write((const uint8_t *)data, len);
+}
+
+/**
+  * @brief  UART interrupt, signals the end of a DMA transmission (TC).
+  * @retval None
+  */
+void UART_LOG_UART_IRQHandler(void)
+{
+  HAL_UART_IRQHandler(pxLogUart);
+}
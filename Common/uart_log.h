@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file           : uart_log.h
+  * @brief          : Non-blocking UART log backend for the FreeRTOS demos
+  ******************************************************************************
+  * @attention
+  *
+  * Writers copy their bytes into a lock-free multi-producer ring and return
+  * immediately. A low-priority logger task drains every committed slot into
+  * one contiguous buffer and sends it with HAL_UART_Transmit_DMA(), so a
+  * burst of printf() calls leaves as a single DMA transfer. uart_log.c also
+  * provides the newlib _write(), so linking it routes printf() here.
+  *
+  ******************************************************************************
+  */
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#include "main.h"
+#include <stdint.h>
+
+/* Payload bytes held by one ring slot; longer writes use several slots */
+#ifndef UART_LOG_SLOT_SIZE
+#define UART_LOG_SLOT_SIZE        32U
+#endif
+
+/* Number of ring slots, must be a power of two */
+#ifndef UART_LOG_SLOTS
+#define UART_LOG_SLOTS            32U
+#endif
+
+/* Size of the buffer handed to the DMA in one transfer */
+#ifndef UART_LOG_DMA_BUF_SIZE
+#define UART_LOG_DMA_BUF_SIZE     256U
+#endif
+
+#ifndef UART_LOG_TASK_STACK
+#define UART_LOG_TASK_STACK       128U
+#endif
+
+#ifndef UART_LOG_TASK_PRIORITY
+#define UART_LOG_TASK_PRIORITY    (tskIDLE_PRIORITY + 1U)
+#endif
+
+/* USART2_TX is mapped on DMA1 Stream6 Channel4 on the STM32F446 */
+#ifndef UART_LOG_DMA_STREAM
+#define UART_LOG_DMA_STREAM       DMA1_Stream6
+#define UART_LOG_DMA_CHANNEL      DMA_CHANNEL_4
+#define UART_LOG_DMA_IRQn         DMA1_Stream6_IRQn
+#define UART_LOG_DMA_IRQHandler   DMA1_Stream6_IRQHandler
+#define UART_LOG_UART_IRQn        USART2_IRQn
+#define UART_LOG_UART_IRQHandler  USART2_IRQHandler
+#endif
+
+/* Must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY */
+#ifndef UART_LOG_IRQ_PRIORITY
+#define UART_LOG_IRQ_PRIORITY     5U
+#endif
+
+void UartLog_Init(UART_HandleTypeDef *huart);
+int UartLog_Write(const uint8_t *data, int len);
+uint32_t UartLog_Dropped(void);
+
+#endif /* UART_LOG_H */
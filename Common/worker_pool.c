@@ -0,0 +1,181 @@
+/**
+  ******************************************************************************
+  * @file           : worker_pool.c
+  * @brief          : Worker pool throughput benchmark
+  ******************************************************************************
+  * @attention
+  *
+  * The producer and the workers share one priority, so on a single core
+  * they round-robin on the tick and the queue stays mostly full. Each worker
+  * only writes its own counter, the controller reads them once the run time
+  * has elapsed and before the tasks are deleted.
+  *
+  * Each run waits for the task count to drop back before the next one, so
+  * the idle task has freed every TCB and stack the deletes left behind (on
+  * SMP a task running on the other core is only freed by idle). A run whose
+  * queue or tasks cannot be created ends the sweep.
+  *
+  ******************************************************************************
+  */
+#include "worker_pool.h"
+#include "task.h"
+#include "queue.h"
+#include <stdio.h>
+
+static QueueHandle_t xJobQueue;
+static volatile uint32_t ulJobsDone[WORKER_POOL_MAX_WORKERS];
+static volatile uint32_t ulJobSink;   /* Keeps the job loop from being optimised out */
+
+/* Ticks the controller waits at most for the idle task to free a run */
+#define WORKER_POOL_RECLAIM_TICKS   100U
+
+/**
+  * @brief  Producer: keeps the job queue full.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvProducerTask(void *pvParameters)
+{
+  uint32_t ulJob = 0U;
+
+  (void)pvParameters;
+  for (;;)
+  {
+    (void)xQueueSend(xJobQueue, &ulJob, portMAX_DELAY);
+    ulJob++;
+  }
+}
+
+/**
+  * @brief  Worker: takes a job from the shared queue and runs it.
+  * @param  pvParameters: worker index
+  * @retval None
+  */
+static void prvWorkerTask(void *pvParameters)
+{
+  uint32_t ulIndex = (uint32_t)(uintptr_t)pvParameters;
+  uint32_t ulJob, ulAcc, i;
+
+  for (;;)
+  {
+    (void)xQueueReceive(xJobQueue, &ulJob, portMAX_DELAY);
+    ulAcc = ulJob;
+    for (i = 0U; i < WORKER_POOL_JOB_LOOPS; i++)
+    {
+      ulAcc = (ulAcc * 1103515245U) + 12345U;
+    }
+    ulJobSink = ulAcc;
+    ulJobsDone[ulIndex]++;
+  }
+}
+
+/**
+  * @brief  Prints the result of one run.
+  * @param  uxWorkers: number of workers in the run
+  * @retval None
+  */
+static void prvReport(UBaseType_t uxWorkers)
+{
+  uint32_t ulTotal = 0U;
+  UBaseType_t i;
+
+  for (i = 0U; i < uxWorkers; i++)
+  {
+    ulTotal += ulJobsDone[i];
+  }
+  printf("workers=%u jobs=%lu jobs/s=%lu  per worker:", (unsigned)uxWorkers,
+         (unsigned long)ulTotal,
+         (unsigned long)(((uint64_t)ulTotal * 1000U) / WORKER_POOL_RUN_MS));
+  for (i = 0U; i < uxWorkers; i++)
+  {
+    printf(" %lu", (unsigned long)ulJobsDone[i]);
+  }
+  printf("\r\n");
+}
+
+/**
+  * @brief  Runs the pool with 1 .. WORKER_POOL_MAX_WORKERS workers, then
+  *         deletes itself.
+  * @param  pvParameters: unused
+  * @retval None
+  */
+static void prvControllerTask(void *pvParameters)
+{
+  TaskHandle_t xWorkers[WORKER_POOL_MAX_WORKERS];
+  TaskHandle_t xProducer = NULL;
+  UBaseType_t uxWorkers, uxCreated, uxBaseTasks, i;
+  BaseType_t xOk;
+  uint32_t ulWait;
+
+  (void)pvParameters;
+  printf("worker pool: %u loops per job, %u ms per run\r\n",
+         (unsigned)WORKER_POOL_JOB_LOOPS, (unsigned)WORKER_POOL_RUN_MS);
+  for (uxWorkers = 1U; uxWorkers <= WORKER_POOL_MAX_WORKERS; uxWorkers++)
+  {
+    uxBaseTasks = uxTaskGetNumberOfTasks();
+    xJobQueue = xQueueCreate(WORKER_POOL_QUEUE_LENGTH, sizeof(uint32_t));
+    xOk = (xJobQueue != NULL) ? pdPASS : pdFAIL;
+
+    /* Only the handles of created tasks are kept, the others are never deleted */
+    uxCreated = 0U;
+    for (i = 0U; (i < uxWorkers) && (xOk == pdPASS); i++)
+    {
+      ulJobsDone[i] = 0U;
+      xOk = xTaskCreate(prvWorkerTask, "Pool Worker", WORKER_POOL_TASK_STACK,
+                        (void *)(uintptr_t)i, WORKER_POOL_PRIORITY, &xWorkers[i]);
+      if (xOk == pdPASS)
+      {
+        uxCreated++;
+#if defined(configNUMBER_OF_CORES) && (configNUMBER_OF_CORES > 1) && (configUSE_CORE_AFFINITY == 1)
+        vTaskCoreAffinitySet(xWorkers[i], (UBaseType_t)1U << (i % configNUMBER_OF_CORES));
+#endif
+      }
+    }
+    if (xOk == pdPASS)
+    {
+      xOk = xTaskCreate(prvProducerTask, "Pool Producer", WORKER_POOL_TASK_STACK, NULL,
+                        WORKER_POOL_PRIORITY, &xProducer);
+    }
+
+    if (xOk == pdPASS)
+    {
+      vTaskDelay(pdMS_TO_TICKS(WORKER_POOL_RUN_MS));
+      vTaskDelete(xProducer);
+    }
+    for (i = 0U; i < uxCreated; i++)
+    {
+      vTaskDelete(xWorkers[i]);
+    }
+    if (xJobQueue != NULL)
+    {
+      vQueueDelete(xJobQueue);
+    }
+
+    /* Let the idle task free the deleted tasks before the next, larger run */
+    for (ulWait = 0U; (uxTaskGetNumberOfTasks() > uxBaseTasks) &&
+                      (ulWait < WORKER_POOL_RECLAIM_TICKS); ulWait++)
+    {
+      vTaskDelay(1);
+    }
+
+    if (xOk != pdPASS)
+    {
+      printf("workers=%u: out of memory, sweep stopped\r\n", (unsigned)uxWorkers);
+      break;
+    }
+    prvReport(uxWorkers);
+  }
+  printf("worker pool: done\r\n");
+  vTaskDelete(NULL);
+}
+
+/**
+  * @brief  Creates the controller task, call before vTaskStartScheduler().
+  * @retval None
+  */
+void WorkerPool_Start(void)
+{
+  /* Above the pool so it wakes on time and the deletes are not preempted */
+  xTaskCreate(prvControllerTask, "Pool Ctrl", WORKER_POOL_TASK_STACK + 128U, NULL,
+              WORKER_POOL_PRIORITY + 2U, NULL);
+}
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file           : worker_pool.h
+  * @brief          : Worker pool throughput benchmark
+  ******************************************************************************
+  * @attention
+  *
+  * One producer fills a shared job queue and N worker tasks drain it, each
+  * job being WORKER_POOL_JOB_LOOPS iterations of CPU work. The pool is run
+  * for WORKER_POOL_RUN_MS with N = 1 .. WORKER_POOL_MAX_WORKERS and every
+  * run reports the total jobs per second and the jobs done by each worker.
+  *
+  * On a single core the total stays flat as N grows (the extra workers only
+  * add switching), so the sweep shows the pool overhead. On an SMP kernel
+  * (configNUMBER_OF_CORES > 1, e.g. RP2040) it should scale up to the core
+  * count; with configUSE_CORE_AFFINITY worker i is pinned to core
+  * i % configNUMBER_OF_CORES.
+  *
+  * Needs dynamic allocation and INCLUDE_vTaskDelete, like latency_bench.
+  *
+  ******************************************************************************
+  */
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "FreeRTOS.h"
+
+#ifndef WORKER_POOL_MAX_WORKERS
+#define WORKER_POOL_MAX_WORKERS     4U
+#endif
+
+#ifndef WORKER_POOL_QUEUE_LENGTH
+#define WORKER_POOL_QUEUE_LENGTH    8U
+#endif
+
+/* Busy loop iterations per job, sets the work to queue overhead ratio */
+#ifndef WORKER_POOL_JOB_LOOPS
+#define WORKER_POOL_JOB_LOOPS       2000U
+#endif
+
+#ifndef WORKER_POOL_RUN_MS
+#define WORKER_POOL_RUN_MS          2000U
+#endif
+
+#ifndef WORKER_POOL_PRIORITY
+#define WORKER_POOL_PRIORITY        (tskIDLE_PRIORITY + 1U)
+#endif
+
+#ifndef WORKER_POOL_TASK_STACK
+#define WORKER_POOL_TASK_STACK      (configMINIMAL_STACK_SIZE + 64U)
+#endif
+
+void WorkerPool_Start(void);
+
+#endif /* WORKER_POOL_H */
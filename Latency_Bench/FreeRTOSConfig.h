@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file           : FreeRTOSConfig.h
+  * @brief          : Kernel configuration for the POSIX latency benchmark
+  ******************************************************************************
+  * @attention
+  *
+  * Kept close to the STM32 demos (preemption, 1 kHz tick) so the relative
+  * results carry over. Absolute numbers come from the Linux scheduler.
+  *
+  ******************************************************************************
+  */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#define configUSE_PREEMPTION                    1
+#define configUSE_IDLE_HOOK                     1
+#define configUSE_TICK_HOOK                     0
+#define configTICK_RATE_HZ                      ((TickType_t)1000)
+#define configMAX_PRIORITIES                    7
+#define configMINIMAL_STACK_SIZE                ((unsigned short)256)
+#define configTOTAL_HEAP_SIZE                   ((size_t)(256 * 1024))
+#define configMAX_TASK_NAME_LEN                 16
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_MUTEXES                       1
+#define configQUEUE_REGISTRY_SIZE               0
+#define configUSE_TIMERS                        1
+#define configTIMER_TASK_PRIORITY               (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH                10
+#define configTIMER_TASK_STACK_DEPTH            configMINIMAL_STACK_SIZE
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configSUPPORT_STATIC_ALLOCATION         0
+#define configCHECK_FOR_STACK_OVERFLOW          0
+
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_vTaskDelay                      1
+
+extern void vAssertCalled(const char *pcFile, unsigned long ulLine);
+#define configASSERT(x)  if ((x) == 0) vAssertCalled(__FILE__, __LINE__)
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file           : main.c
+  * @brief          : Runs the inter-task latency or worker pool benchmark on
+  *                    the POSIX port
+  ******************************************************************************
+  */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "latency_bench.h"
+#include "worker_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+  * @brief  Stops the process once the controller task has deleted itself.
+  * @retval None
+  */
+void vApplicationIdleHook(void)
+{
+  /* Idle plus the POSIX timer task are all that is left after the run */
+  if (uxTaskGetNumberOfTasks() <= 2U)
+  {
+    fflush(stdout);
+    exit(0);
+  }
+}
+
+void vAssertCalled(const char *pcFile, unsigned long ulLine)
+{
+  fprintf(stderr, "assert failed: %s:%lu\n", pcFile, ulLine);
+  abort();
+}
+
+int main(void)
+{
+#ifdef RUN_WORKER_POOL
+  WorkerPool_Start();
+#else
+  LatencyBench_Start();
+#endif
+  vTaskStartScheduler();
+  return 1;
+}
@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file           : tickless_step_test.c
+  * @brief          : Host test of the tickless_rtc.c tick step arithmetic
+  ******************************************************************************
+  * @attention
+  *
+  * Runs TicklessStep_Ticks() from Common/tickless_step.h on the host, no
+  * kernel needed: make test-tickless. Checks that the carried remainder
+  * keeps the stepped ticks equal to the RTC time over many short sleeps,
+  * the hour wrap of the calendar position, the clamp to the expected idle
+  * time and the longest sleep the wakeup timer allows.
+  *
+  ******************************************************************************
+  */
+#include "tickless_step.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned uChecks;
+static unsigned uFailures;
+
+#define CHECK(cond)                                                         \
+  do                                                                        \
+  {                                                                         \
+    uChecks++;                                                              \
+    if (!(cond))                                                            \
+    {                                                                       \
+      uFailures++;                                                          \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                \
+    }                                                                       \
+  } while (0)
+
+/**
+  * @brief  Many sleeps of random length: ticks * SUBSEC_HZ + residual must
+  *         always equal the RTC units slept times the tick rate.
+  * @param  ulTickHz: configTICK_RATE_HZ under test
+  * @param  ulMaxUnits: longest sleep, in RTC units
+  */
+static void prvCheckCarry(uint32_t ulTickHz, uint32_t ulMaxUnits)
+{
+  uint64_t ullUnits = 0U, ullTicks = 0U;
+  uint32_t ulResidual = 0U, ulPos = 0U, ulSleep, ulEnd;
+  unsigned i, uBad = 0U;
+
+  srand(ulTickHz);
+  for (i = 0U; i < 100000U; i++)
+  {
+    ulSleep = (uint32_t)rand() % (ulMaxUnits + 1U);
+    ulEnd = (ulPos + ulSleep) % TICKLESS_RTC_UNITS_PER_HOUR;
+    ullTicks += TicklessStep_Ticks(ulPos, ulEnd, ulTickHz, UINT32_MAX, &ulResidual);
+    ullUnits += ulSleep;
+    ulPos = ulEnd;
+    if ((ullTicks * TICKLESS_RTC_SUBSEC_HZ + ulResidual != ullUnits * ulTickHz) ||
+        (ulResidual >= TICKLESS_RTC_SUBSEC_HZ))
+    {
+      uBad++;
+    }
+  }
+  CHECK(uBad == 0U);
+}
+
+int main(void)
+{
+  uint32_t ulResidual, ulTicks, i;
+
+  /* 1 unit is 0.244 ticks at 1 kHz: 4096 of them make exactly 1000 ticks */
+  ulResidual = 0U;
+  ulTicks = 0U;
+  for (i = 0U; i < TICKLESS_RTC_SUBSEC_HZ; i++)
+  {
+    ulTicks += TicklessStep_Ticks(i, i + 1U, 1000U, UINT32_MAX, &ulResidual);
+  }
+  CHECK(ulTicks == 1000U);
+  CHECK(ulResidual == 0U);
+
+  /* Calendar position wrapping at the hour */
+  ulResidual = 0U;
+  ulTicks = TicklessStep_Ticks(TICKLESS_RTC_UNITS_PER_HOUR - 2048U, 2048U, 1000U,
+                               UINT32_MAX, &ulResidual);
+  CHECK(ulTicks == 1000U);
+  CHECK(ulResidual == 0U);
+
+  /* No time passed */
+  ulResidual = 17U;
+  CHECK(TicklessStep_Ticks(1234U, 1234U, 1000U, UINT32_MAX, &ulResidual) == 0U);
+  CHECK(ulResidual == 17U);
+
+  /* Overslept: the step stops at the expected idle time */
+  ulResidual = 0U;
+  CHECK(TicklessStep_Ticks(0U, TICKLESS_RTC_SUBSEC_HZ, 1000U, 300U, &ulResidual) == 300U);
+  CHECK(ulResidual < TICKLESS_RTC_SUBSEC_HZ);
+
+  /* Longest sleep, 0x10000 wakeup counts of 2 units, plus the residual */
+  ulResidual = TICKLESS_RTC_SUBSEC_HZ - 1U;
+  ulTicks = TicklessStep_Ticks(0U, 0x20000U, 1000U, UINT32_MAX, &ulResidual);
+  CHECK(ulTicks == 32000U);
+  CHECK(ulResidual == TICKLESS_RTC_SUBSEC_HZ - 1U);
+
+  prvCheckCarry(1000U, 64U);
+  prvCheckCarry(1000U, 0x20000U);
+  prvCheckCarry(100U, 4096U);
+  prvCheckCarry(1024U, 300U);
+
+  printf("tickless_step: %u checks, %u failed\n", uChecks, uFailures);
+  return (uFailures == 0U) ? 0 : 1;
+}
@@ -3,7 +3,9 @@
  * @brief ADC-based PWM control for AVR microcontroller
  *
  * This program reads an analog voltage using the ADC and adjusts the PWM duty cycle
- * based on the input voltage.
+ * based on the input voltage. By default every ADC0 result is low-pass filtered
+ * and mapped linearly to OCR0A from the ADC interrupt; PWM_MODE_LADDER keeps the
+ * former 0/25/50/75/100 % steps.
  *
  * @author kandyala sai kumar
  * @date 2025-01-08
@@ -14,21 +16,59 @@
 #include <util/delay.h>
 #include <stdbool.h>
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "adc_scan.h"
 
-#define DIV_FACTOR ((float)100.0) ///< Factor for duty cycle calculation
-#define MAX_VALUE  ((float)255.0) ///< Maximum OCR0A value
+#define PWM_MODE_LADDER     0 ///< Five duty steps, updated by the main loop
+#define PWM_MODE_CONTINUOUS 1 ///< Filtered linear mapping, updated every sweep
+
+#ifndef PWM_MODE
+#define PWM_MODE    PWM_MODE_CONTINUOUS
+#endif
+
+#define DIV_FACTOR  100U ///< Factor for duty cycle calculation
+#define MAX_VALUE   255U ///< Maximum OCR0A value
 #define DELAY_MS    10000 ///< Delay in milliseconds
 #define DCCINCFCTR  20 ///< Duty cycle increment factor
 #define MAXDC       100 ///< Maximum duty cycle
 #define MINDC        0 ///< Minimum duty cycle
+#define ADC_PERIOD_US 1000U ///< Time between two ADC conversions
+#define ADC_VREF_V    5U ///< ADC reference in volts
+#define ADC_BITS     10U ///< ADC resolution
+#define FILTER_SHIFT  3U ///< IIR weight 1/8, time constant 8 sweeps (8 ms)
+#define PWM_HYST      4U ///< ADC codes the input must move before OCR0A follows
+
+/** OCR0A for a duty cycle in percent, evaluated by the compiler */
+#define DUTY_TO_OCR(dc) ((uint8_t)(((dc) * MAX_VALUE) / DIV_FACTOR))
+
+/** Channels sampled by the scan engine, ADC0 drives the PWM */
+static const uint8_t adc_channels[] = {0U};
+
+/**
+ * @brief Duty cycle step for each whole volt (index = (adc * 5) >> 10).
+ *
+ * Same ladder as the former float code: 2 V -> 25 %, 3 V -> 50 %,
+ * 4 V -> 75 %, i.e. ADC codes 410, 615 and 820. 5 V (100 %) would need
+ * code 1024 and is kept only for completeness.
+ */
+static const uint8_t duty_lut[ADC_VREF_V + 1U] = {MINDC, MINDC, 25U, 50U, 75U, MAXDC};
+
+/** OCR0A for each entry of duty_lut, no arithmetic left at run time */
+static const uint8_t ocr_lut[ADC_VREF_V + 1U] =
+{
+    DUTY_TO_OCR(MINDC), DUTY_TO_OCR(MINDC), DUTY_TO_OCR(25U),
+    DUTY_TO_OCR(50U), DUTY_TO_OCR(75U), DUTY_TO_OCR(MAXDC)
+};
 
 /**
  * @brief Global variables for ADC and PWM
  */
-int dutycycle; ///< Duty cycle percentage
+uint8_t dutycycle; ///< Duty cycle percentage
 volatile bool intrpt_rcvd = false; ///< Interrupt received flag
-int adc_value; ///< ADC read value
-float voltage_value; ///< Converted voltage value
+uint16_t adc_value; ///< ADC read value
+uint8_t voltage_value; ///< Converted voltage value, whole volts
+volatile uint16_t filter_acc; ///< IIR state, filtered ADC0 scaled by 2^FILTER_SHIFT
+volatile uint16_t adc_filtered; ///< Filtered value OCR0A was last taken from
 
 /**
  * @brief Initializes ADC module
@@ -46,57 +86,76 @@ void PWM_init(void);
 void ADC_PWM(void);
 
 /**
- * @brief Reads ADC value
- * @return int ADC read value
+ * @brief Returns the latest ADC0 result of the scan engine, without waiting
+ * @return uint16_t ADC read value
  */
-int Read_ADC(void);
+uint16_t Read_ADC(void);
 
 /**
- * @brief Converts ADC value to voltage
+ * @brief Converts ADC value to whole volts, (adc * 5) / 1024 by shift
  * @param adcinput ADC read value
- * @return int Converted voltage value
+ * @return uint8_t Converted voltage value
  */
-int Convert_voltage(int adcinput);
+uint8_t Convert_Voltage(uint16_t adcinput);
 
 /**
  * @brief Generates PWM based on voltage input
- * @param voltageinput Voltage read from ADC
- * @return float PWM duty cycle percentage
+ * @param voltageinput Voltage read from ADC, whole volts
+ * @return uint8_t PWM duty cycle percentage
  */
-float generate_PWM(float voltageinput);
+uint8_t generate_PWM(uint8_t voltageinput);
+
+/**
+ * @brief Filters ADC0 and moves OCR0A, called by the scan engine in interrupt
+ *        context once per sweep, i.e. every ADC_PERIOD_US
+ * @param sweep Latest sweep, sweep[0] is ADC0
+ */
+void PWM_Control(const volatile uint16_t *sweep);
 
 int main(void)
 {
     ADC_init();
     PWM_init();
+#if (PWM_MODE == PWM_MODE_CONTINUOUS)
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while(1)
+    {
+        sleep_mode(); ///< All the work is done by PWM_Control()
+    }
+#else
     while(1)
     {
         ADC_PWM();
     }
+#endif
     return 0;
 }
 
 void ADC_init(void)
 {
    DDRD = 0xFF; ///< Set Port D as output
-   ADMUX = 0x00; ///< Select ADC0 channel
-   ADCSRA = 0x87; ///< Enable ADC and set prescaler
+   AdcScan_Init(adc_channels, sizeof(adc_channels), ADC_PERIOD_US); ///< Timer1 triggered conversions
+#if (PWM_MODE == PWM_MODE_CONTINUOUS)
+   AdcScan_SetCallback(PWM_Control); ///< Fixed rate control, before sei()
+#endif
 }
 
 void PWM_init(void)
 {
     DDRD = (1<<PORTD6); ///< Set PD6 as output
     TCCR0A = (1<<WGM00) | (1<<WGM01) | (1<<COM0A1); ///< Fast PWM mode
+#if (PWM_MODE == PWM_MODE_LADDER)
     TIMSK0 = (1<<TOIE0); ///< Enable Timer0 overflow interrupt
-    OCR0A = ((dutycycle / DIV_FACTOR) * MAX_VALUE);
+#endif
+    OCR0A = DUTY_TO_OCR(dutycycle);
     sei(); ///< Enable global interrupts
     TCCR0B = (1<<CS00); ///< Start Timer0 with no prescaler
 }
 
-int Convert_Voltage(int adcinput)
+uint8_t Convert_Voltage(uint16_t adcinput)
 {
-    voltage_value = (adcinput / 1024.0) * 5.0;
-    return voltage_value;
+    /** 1023 * 5 = 5115 fits in 16 bits; truncates like the former float-to-int return */
+    return (uint8_t)((adcinput * ADC_VREF_V) >> ADC_BITS);
 }
 
 void ADC_PWM(void)
@@ -106,43 +165,54 @@ void ADC_PWM(void)
     generate_PWM(voltage_value);
 }
 
-int Read_ADC(void)
+uint16_t Read_ADC(void)
 {
-    ADCSRA |= (1<<ADSC); ///< Start ADC conversion
-    while(ADCSRA & (1<<ADSC)); ///< Wait for conversion to complete
-    return ADC;
+    uint16_t sweep[sizeof(adc_channels)];
+
+    (void)AdcScan_Read(sweep); ///< Latest complete sweep, never blocks
+    return sweep[0];
 }
 
-float generate_PWM(float voltageinput)
+uint8_t generate_PWM(uint8_t voltageinput)
 {
     if (intrpt_rcvd == true)
     {
-        if (voltage_value == 5.0)
+        if (voltageinput > ADC_VREF_V)
         {
-            dutycycle = 100;
-        }
-        else if (voltage_value >= 4.0)
-        {
-            dutycycle = 75;
-        }
-        else if (voltage_value >= 3.0)
-        {
-            dutycycle = 50;
-        }
-        else if (voltage_value >= 2.0)
-        {
-            dutycycle = 25;
-        }
-        else
-        {
-            dutycycle = 0;
+            voltageinput = ADC_VREF_V;
         }
+        dutycycle = duty_lut[voltageinput];
         intrpt_rcvd = false; ///< Reset the flag
-        OCR0A = ((dutycycle / DIV_FACTOR) * MAX_VALUE);
+        OCR0A = ocr_lut[voltageinput];
     }
     return dutycycle;
 }
 
+void PWM_Control(const volatile uint16_t *sweep)
+{
+    uint16_t filtered;
+    uint8_t ocr;
+
+    adc_value = sweep[0];
+
+    /** y += (x - y) / 8, kept scaled by 8: at most 1023 * 8, fits in 16 bits */
+    filter_acc = (uint16_t)(filter_acc + adc_value - (filter_acc >> FILTER_SHIFT));
+    filtered = (uint16_t)(filter_acc >> FILTER_SHIFT);
+
+    /** Dead band around the last output, so noise on a step edge cannot toggle OCR0A */
+    if ((filtered >= (uint16_t)(adc_filtered + PWM_HYST)) ||
+        ((uint16_t)(filtered + PWM_HYST) <= adc_filtered))
+    {
+        adc_filtered = filtered;
+        ocr = (uint8_t)(filtered >> (ADC_BITS - 8U)); ///< 0..1023 -> 0..255
+        if (ocr != OCR0A)
+        {
+            OCR0A = ocr;
+        }
+    }
+}
+
+#if (PWM_MODE == PWM_MODE_LADDER)
 /**
  * @brief Timer0 overflow interrupt service routine
  */
@@ -150,3 +220,4 @@ ISR(TIMER0_OVF_vect)
 {
     intrpt_rcvd = true; ///< Set interrupt received flag
 }
+#endif
@@ -23,6 +23,10 @@
 /* USER CODE BEGIN Includes */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "tickless_rtc.h"
+#include "periodic_job.h"
+#define BOARD_LED_PINS      (GPIO_PIN_5 | GPIO_PIN_6)
+#include "board.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -43,20 +47,19 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-TaskHandle_t xGreenLedTask1Handle;
-TaskHandle_t xGreenLedTask2Handle;
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
-void SystemClock_Config(void);
-static void MX_GPIO_Init(void);
 /* USER CODE BEGIN PFP */
-void vGreenLedTask1(void *pvParameters);
-void vGreenLedTask2(void *pvParameters);
+void vGreenLedJob(void *pvArg);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+/* Each LED is a periodic job on the shared dispatcher task, not a task */
+PeriodicJob_t xGreenLedJob1 = PERIODIC_JOB_INIT(vGreenLedJob, (void *)GPIO_PIN_5, 1000);
+PeriodicJob_t xGreenLedJob2 = PERIODIC_JOB_INIT(vGreenLedJob, (void *)GPIO_PIN_6, 2000);
 
 /* USER CODE END 0 */
 
@@ -88,10 +91,15 @@ int main(void)
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
-  MX_GPIO_Init();
+  Board_GpioInit();
   /* USER CODE BEGIN 2 */
-  xTaskCreate(vGreenLedTask1,"Green Led Task1",128,NULL,1,&xGreenLedTask1Handle);
-  xTaskCreate(vGreenLedTask2,"Green Led Task2",128,NULL,1,&xGreenLedTask2Handle);
+#if (configUSE_TICKLESS_IDLE == 2)
+  /* The dispatcher spends nearly all its time blocked: sleep in STOP mode */
+  Tickless_Init();
+#endif
+  PeriodicJob_Add(&xGreenLedJob1);
+  PeriodicJob_Add(&xGreenLedJob2);
+  PeriodicJob_Start();
   vTaskStartScheduler();
   /* USER CODE END 2 */
 
@@ -106,87 +114,10 @@ int main(void)
   /* USER CODE END 3 */
 }
 
-/**
-  * @brief System Clock Configuration
-  * @retval None
-  */
-void SystemClock_Config(void)
-{
-  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
-
-  /** Configure the main internal regulator output voltage
-  */
-  __HAL_RCC_PWR_CLK_ENABLE();
-  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
-
-  /** Initializes the RCC Oscillators according to the specified parameters
-  * in the RCC_OscInitTypeDef structure.
-  */
-  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
-  RCC_OscInitStruct.HSIState = RCC_HSI_ON;
-  RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
-  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
-  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
-  {
-    Error_Handler();
-  }
-
-  /** Initializes the CPU, AHB and APB buses clocks
-  */
-  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
-                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
-  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
-  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
-
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK)
-  {
-    Error_Handler();
-  }
-}
-
-/**
-  * @brief GPIO Initialization Function
-  * @param None
-  * @retval None
-  */
-static void MX_GPIO_Init(void)
-{
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
-/* USER CODE BEGIN MX_GPIO_Init_1 */
-/* USER CODE END MX_GPIO_Init_1 */
-
-  /* GPIO Ports Clock Enable */
-  __HAL_RCC_GPIOA_CLK_ENABLE();
-
-  /*Configure GPIO pin Output Level */
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5|GPIO_PIN_6, GPIO_PIN_RESET);
-
-  /*Configure GPIO pins : PA5 PA6 */
-  GPIO_InitStruct.Pin = GPIO_PIN_5|GPIO_PIN_6;
-  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
-  GPIO_InitStruct.Pull = GPIO_NOPULL;
-  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-  HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
-/* USER CODE BEGIN MX_GPIO_Init_2 */
-/* USER CODE END MX_GPIO_Init_2 */
-}
-
 /* USER CODE BEGIN 4 */
-void vGreenLedTask1(void *pvParameters)
-{
-	for(;;)
-	HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_5);
-	vTaskDelay(pdMS_TO_TICKS(1000));
-}
-void vGreenLedTask2(void *pvParameters)
+void vGreenLedJob(void *pvArg)
 {
-	for(;;)
-	HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_6);
-	vTaskDelay(pdMS_TO_TICKS(2000));
+	HAL_GPIO_TogglePin(GPIOA, (uint16_t)(uint32_t)pvArg);
 }
 /* USER CODE END 4 */
 
@@ -3,7 +3,10 @@
  * @brief PWM control using Timer0 on AVR
  *
  * This program generates a PWM signal on PD6 using Timer0 in fast PWM mode.
- * The duty cycle is updated periodically using an overflow interrupt.
+ * The duty cycle is updated periodically by a task of the AVR_Common
+ * cooperative scheduler, whose 1 ms tick is the Timer0 overflow interrupt.
+ * With USE_GAMMA_PWM set to 1 the LED moves to PB1 (OC1A) and fades
+ * smoothly between the steps, gamma corrected, using AVR_Common/gamma_pwm.c.
  *
  * @author kANDYALA SAI KUMAR
  * @date 2025-01-07
@@ -11,78 +14,104 @@
 
 #define F_CPU 16000000UL  /**< CPU Clock Frequency */
 #include <avr/io.h>
-#include <util/delay.h>
 #include <stdbool.h>
 #include <avr/interrupt.h>
+#include "sched.h"
 
 /** @brief Constants for PWM calculation */
 #define DIV_FACTOR 100.0  /**< Division factor for duty cycle calculation */
 #define MAX_VALUE 255.0   /**< Maximum PWM register value */
-#define DELAY_MS 10000    /**< Delay in milliseconds */
+#define STEP_PERIOD_MS 1000U /**< Time between two duty cycle steps */
 #define DCCINCFCTR 10     /**< Duty cycle increment factor */
 #define MAXDC 100         /**< Maximum duty cycle percentage */
 #define MINDC 0           /**< Minimum duty cycle percentage */
 
+/** @brief Set to 1 for the gamma corrected 14-bit fade on PB1 */
+#ifndef USE_GAMMA_PWM
+#define USE_GAMMA_PWM 0
+#endif
+
+#if (USE_GAMMA_PWM == 1)
+#include "gamma_pwm.h"
+
+#define FADE_MS STEP_PERIOD_MS /**< Fade time of one duty cycle step */
+#define FADE_POLL_MS 10U  /**< Period of the task waiting for the fade end */
+#endif
+
 int dutycycle = 25;            /**< Initial duty cycle value */
-volatile bool intrpt_rcvd = false; /**< Interrupt received flag */
+
+/**
+ * @brief Advances the duty cycle by one step, wrapping to 0 % above 100 %.
+ */
+static void Next_DutyCycle(void)
+{
+    dutycycle += DCCINCFCTR;
+    if (dutycycle > MAXDC)
+    {
+        dutycycle = MINDC;
+    }
+}
+
+#if (USE_GAMMA_PWM == 1)
+/**
+ * @brief Starts the next fade once the previous one has ended.
+ */
+void Fade_Task(void)
+{
+    if (GammaPwm_Busy(0U) == 0U)
+    {
+        Next_DutyCycle();
+
+        // Percent to perceptual level 0..255, integer only
+        GammaPwm_FadeTo(0U, (uint8_t)(((uint16_t)dutycycle * 255U) / MAXDC), FADE_MS);
+    }
+}
+#else
+/**
+ * @brief Duty cycle task, runs every STEP_PERIOD_MS.
+ */
+void Step_Task(void)
+{
+    Next_DutyCycle();
+
+    // Set new duty cycle value to OCR0A
+    OCR0A = ((dutycycle / DIV_FACTOR) * MAX_VALUE);
+}
+#endif
 
 /**
  * @brief Main function to configure and start PWM
  *
- * Configures Timer0 in fast PWM mode and sets up an overflow interrupt.
- * The duty cycle is updated inside the interrupt handler.
+ * Configures Timer0 in fast PWM mode and starts the scheduler, which runs
+ * the duty cycle task and sleeps in idle mode in between.
  *
  * @return int Return 0 on successful execution.
  */
 int main(void)
 {
+#if (USE_GAMMA_PWM == 1)
+    GammaPwm_Init(GAMMA_PWM_OC1A);
+    Sched_Init();
+    (void)Sched_Add(Fade_Task, FADE_POLL_MS, 0U);
+#else
     // Set PD6 as an output for PWM
     DDRD = (1 << PORTD6);
 
     // Configure Timer0 in Fast PWM mode, non-inverting mode
     TCCR0A = (1 << WGM00) | (1 << WGM01) | (1 << COM0A1);
 
-    // Enable Timer0 overflow interrupt
-    TIMSK0 = (1 << TOIE0);
-
     // Set initial duty cycle value to OCR0A
     OCR0A = ((dutycycle / DIV_FACTOR) * MAX_VALUE);
 
+    // Start the timer at prescaler 64 (976 Hz PWM) with the 1 ms tick
+    Sched_Init();
+    (void)Sched_Add(Step_Task, STEP_PERIOD_MS, STEP_PERIOD_MS);
+#endif
+
     // Enable global interrupts
     sei();
 
-    // Start the timer with no prescaler
-    TCCR0B = (1 << CS00);
-
-    while (1)
-    {
-        if (intrpt_rcvd == true)
-        {
-            _delay_ms(1000);
-
-            // Update duty cycle
-            dutycycle += DCCINCFCTR;
-            if (dutycycle > MAXDC)
-            {
-                dutycycle = MINDC;
-            }
-            intrpt_rcvd = false; // Reset flag
-
-            // Set new duty cycle value to OCR0A
-            OCR0A = ((dutycycle / DIV_FACTOR) * MAX_VALUE);
-        }
-    }
+    Sched_Run();
 
     return 0;
 }
-
-/**
- * @brief Timer0 Overflow Interrupt Service Routine
- *
- * This ISR sets the interrupt received flag to true, signaling the main loop
- * to update the PWM duty cycle.
- */
-ISR(TIMER0_OVF_vect)
-{
-    intrpt_rcvd = true;
-}
@@ -5,18 +5,26 @@
  * This file contains functions to initialize and control PWM signals for
  * various pins using the AVR microcontroller. It utilizes the 8-bit and 16-bit
  * timers to generate PWM waveforms, and uses interrupts to modify the duty cycle
- * of the PWM signals.
+ * of the PWM signals. The channels are listed once in PWM_CHANNELS; the init
+ * and update code is generated from that table at compile time. With
+ * USE_SOFT_PWM, PB3 and PC0..PC5 are driven by the software PWM engine of
+ * AVR_Common, which takes Timer2. With USE_GAMMA_PWM, PB1 and PB2 fade through
+ * the gamma corrected 14-bit Timer1 mode of AVR_Common/gamma_pwm.c. The duty
+ * cycle steps run as a periodic task of the AVR_Common cooperative scheduler,
+ * which takes the Timer0 overflow as its 1 ms tick.
  *
  * @author Kandyala sai kumar
  * @date 2025-01-13
  * @version 1.0
  */
 
-#define F_CPU 16000000UL /**< Clock frequency definition for delay functions. */
+#define F_CPU 16000000UL /**< Clock frequency definition. */
 #include <avr/io.h>
-#include <util/delay.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
 #include <stdbool.h>
+#include "sched.h"
 
 /**
  * @def MAXDC
@@ -37,20 +45,195 @@
 #define MAX_VALUE 255
 
 /**
- * @brief Array to store the duty cycle values for 5 PWM outputs.
+ * @def DUTY_PERIOD_MS
+ * @brief Period of the duty cycle task (Duty_Task()).
+ */
+#define DUTY_PERIOD_MS 100U
+
+/**
+ * @def USE_SOFT_PWM
+ * @brief 1 to run PB3 and PC0..PC5 on AVR_Common/soft_pwm.c, 0 for PB3 on OCR2A only.
+ */
+#ifndef USE_SOFT_PWM
+#define USE_SOFT_PWM 1
+#endif
+
+#if (USE_SOFT_PWM == 1)
+#include "soft_pwm.h"
+
+/**
+ * @def PWM_SOFT_CHANNELS
+ * @brief Software PWM channels, X(name, soft_pwm channel), rows as in soft_pwm_config.h.
+ */
+#define PWM_SOFT_CHANNELS(X) \
+    X(PWM_PB3, SOFT_PWM_CHANNEL(0, PORTB3)) \
+    X(PWM_PC0, SOFT_PWM_CHANNEL(1, 0)) \
+    X(PWM_PC1, SOFT_PWM_CHANNEL(1, 1)) \
+    X(PWM_PC2, SOFT_PWM_CHANNEL(1, 2)) \
+    X(PWM_PC3, SOFT_PWM_CHANNEL(1, 3)) \
+    X(PWM_PC4, SOFT_PWM_CHANNEL(1, 4)) \
+    X(PWM_PC5, SOFT_PWM_CHANNEL(1, 5))
+#define PWM_CHANNEL_PB3(X)
+#else
+#define PWM_SOFT_CHANNELS(X)
+#define PWM_CHANNEL_PB3(X) X(PWM_PB3, TCCR2A, COM2A1, OCR2A, DDRB, PORTB3)
+#endif
+
+/**
+ * @def USE_GAMMA_PWM
+ * @brief 1 to run PB1 and PB2 on AVR_Common/gamma_pwm.c (Timer1, 14-bit, gamma 2.2).
+ */
+#ifndef USE_GAMMA_PWM
+#define USE_GAMMA_PWM 0
+#endif
+
+/**
+ * @def GAMMA_FADE_MS
+ * @brief Fade time of the gamma channels to a new duty cycle, one main loop period.
+ */
+#define GAMMA_FADE_MS 100U
+
+#if (USE_GAMMA_PWM == 1)
+#include "gamma_pwm.h"
+
+/**
+ * @def PWM_GAMMA_CHANNELS
+ * @brief Gamma corrected channels, X(name, gamma_pwm channel).
+ */
+#define PWM_GAMMA_CHANNELS(X) \
+    X(PWM_PB1, 0U) \
+    X(PWM_PB2, 1U)
+#define PWM_CHANNEL_PB1_PB2(X)
+#else
+#define PWM_GAMMA_CHANNELS(X)
+#define PWM_CHANNEL_PB1_PB2(X) \
+    X(PWM_PB1, TCCR1A, COM1A1, OCR1A, DDRB, PORTB1) \
+    X(PWM_PB2, TCCR1A, COM1B1, OCR1B, DDRB, PORTB2)
+#endif
+
+/**
+ * @def PWM_CHANNELS
+ * @brief PWM channel table, one X(name, TCCRnA, COM bit, OCR register, DDR, pin)
+ *        row per output.
+ *
+ * The timers themselves are set up in PWM_Init(); a row only connects one of
+ * their compare outputs to its pin. Adding a channel is adding a row.
+ */
+#define PWM_CHANNELS(X) \
+    X(PWM_PD6, TCCR0A, COM0A1, OCR0A, DDRD, PORTD6) \
+    X(PWM_PD5, TCCR0A, COM0B1, OCR0B, DDRD, PORTD5) \
+    PWM_CHANNEL_PB1_PB2(X) \
+    PWM_CHANNEL_PB3(X)
+
+/** @brief Channel indices into dutycycle[], hardware channels first. */
+#define PWM_ENUM(name, tccr, com, ocr, ddr, pin) name,
+#define PWM_LIST_ENUM(name, channel) name,
+enum
+{
+    PWM_CHANNELS(PWM_ENUM)
+    PWM_GAMMA_CHANNELS(PWM_LIST_ENUM)
+    PWM_SOFT_CHANNELS(PWM_LIST_ENUM)
+    PWM_CHANNEL_COUNT
+};
+
+/**
+ * @def DUTY_OCR
+ * @brief OCR value for a duty cycle in percent, only used by the compiler.
+ */
+#define DUTY_OCR(dc) ((uint8_t)(((dc) * MAX_VALUE) / MAXDC))
+#define DUTY_OCR_10(b) \
+    DUTY_OCR(b), DUTY_OCR((b) + 1), DUTY_OCR((b) + 2), DUTY_OCR((b) + 3), \
+    DUTY_OCR((b) + 4), DUTY_OCR((b) + 5), DUTY_OCR((b) + 6), DUTY_OCR((b) + 7), \
+    DUTY_OCR((b) + 8), DUTY_OCR((b) + 9),
+
+/**
+ * @brief OCR value for every duty cycle 0..100 %, kept in flash.
+ *
+ * Replaces the 16-bit multiply and divide per channel of the former
+ * update_PWM() by one table read.
+ */
+static const uint8_t duty_to_ocr[MAXDC + 1] PROGMEM =
+{
+    DUTY_OCR_10(0) DUTY_OCR_10(10) DUTY_OCR_10(20) DUTY_OCR_10(30) DUTY_OCR_10(40)
+    DUTY_OCR_10(50) DUTY_OCR_10(60) DUTY_OCR_10(70) DUTY_OCR_10(80) DUTY_OCR_10(90)
+    DUTY_OCR(MAXDC)
+};
+
+/**
+ * @brief Array to store the duty cycle values for the PWM outputs.
  *
  * This array holds the duty cycle for each PWM channel. The values are
  * expressed as percentages of the maximum duty cycle.
  */
-volatile uint8_t dutycycle[5] = {10, 20, 30, 40, 50};
+volatile uint8_t dutycycle[PWM_CHANNEL_COUNT] = {10, 20, 30, 40, 50};
+
+/**
+ * @brief Duty cycle last written to each OCR register.
+ *
+ * Starts out of range so that the first update_PWM() writes every channel.
+ */
+static uint8_t duty_applied[PWM_CHANNEL_COUNT];
+
+/**
+ * @brief Event sources, one bit of `events` and one entry of `event_count` each.
+ *
+ * Timer0 overflows are the scheduler tick and raise no event. Timer1 and
+ * Timer2 only raise events while they run the hardware PWM channels.
+ */
+#define EVT_TIMER1_OVF  (1U << 0)
+#define EVT_TIMER2_OVF  (1U << 1)
+#define EVT_COUNT       2U
+
+#define EVT_SOURCES     (((USE_GAMMA_PWM == 0) ? EVT_TIMER1_OVF : 0U) | \
+                         ((USE_SOFT_PWM == 0) ? EVT_TIMER2_OVF : 0U))
+
+/**
+ * @brief Pending events, set by the ISRs and taken by Events_Take().
+ *
+ * Each overflow interrupt is one-shot: its ISR disables it and Events_Arm()
+ * enables it again once the event has been handled, so a source interrupts
+ * at most once per DUTY_PERIOD_MS instead of thousands of times per second.
+ */
+volatile uint8_t events;
 
 /**
- * @brief Interrupt flags for each timer overflow interrupt.
+ * @brief Number of events raised by each source since reset.
+ */
+volatile uint16_t event_count[EVT_COUNT];
+
+/**
+ * @brief Enables the overflow interrupt of every event source.
  *
- * This array is used to track if an interrupt has been received for a particular
- * timer overflow.
+ * The overflow flag is cleared first, so the next event reports an overflow
+ * that happened after the previous event was handled.
+ */
+void Events_Arm(void)
+{
+#if (USE_GAMMA_PWM == 0)
+    TIFR1 = (1 << TOV1);
+    TIMSK1 |= (1 << TOIE1);
+#endif
+#if (USE_SOFT_PWM == 0)
+    TIFR2 = (1 << TOV2);
+    TIMSK2 |= (1 << TOIE2);
+#endif
+}
+
+/**
+ * @brief Returns the pending events and clears them, atomically.
+ * @return EVT_* bits
  */
-volatile bool intrpt_rcvd[3] = {false, false, false};
+uint8_t Events_Take(void)
+{
+    uint8_t pending;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pending = events;
+        events = 0U;
+    }
+    return pending;
+}
 
 /**
  * @brief Initializes PWM signals for multiple pins using timers and interrupts.
@@ -62,25 +245,42 @@ volatile bool intrpt_rcvd[3] = {false, false, false};
  */
 void PWM_Init()
 {
-    DDRD = (1 << PORTD6) | (1 << PORTD5); /**< Set PD6, PD5 as output. */
-    DDRB = (1 << PORTB1) | (1 << PORTB2) | (1 << PORTB3); /**< Set PB1, PB2, PB3 as output. */
-
     // Configure Timer0 (8-bit Fast PWM)
-    TCCR0A = (1 << WGM00) | (1 << WGM01) | (1 << COM0A1) | (1 << COM0B1);
-    TCCR0B = (1 << CS01); /**< Prescaler = 8 */
+    TCCR0A = (1 << WGM00) | (1 << WGM01);
+    TCCR0B = (1 << CS01) | (1 << CS00); /**< Prescaler = 64, also the scheduler tick */
 
-    // Configure Timer1 (16-bit Fast PWM)
-    TCCR1A = (1 << WGM10) | (1 << COM1A1) | (1 << COM1B1);
+#if (USE_GAMMA_PWM == 1)
+    // Timer1 drives the gamma corrected channels, 14-bit at prescaler 1
+    GammaPwm_Init(GAMMA_PWM_OC1A | GAMMA_PWM_OC1B);
+#else
+    // Configure Timer1 (16-bit Fast PWM, 8-bit)
+    TCCR1A = (1 << WGM10);
     TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10); /**< Prescaler = 64 */
+#endif
 
+#if (USE_SOFT_PWM == 1)
+    // Timer2 drives the software PWM channels
+    SoftPwm_Init();
+#else
     // Configure Timer2 (8-bit Fast PWM)
-    TCCR2A = (1 << WGM20) | (1 << WGM21) | (1 << COM2A1);
+    TCCR2A = (1 << WGM20) | (1 << WGM21);
     TCCR2B = (1 << CS22); /**< Prescaler = 64 */
+#endif
+
+    // Connect every channel of the table to its pin
+#define PWM_CONNECT(name, tccr, com, ocr, ddr, pin) \
+    tccr |= (1 << com); \
+    ddr |= (1 << pin);
+    PWM_CHANNELS(PWM_CONNECT)
+#undef PWM_CONNECT
+
+    for (uint8_t j = 0; j < PWM_CHANNEL_COUNT; j++)
+    {
+        duty_applied[j] = MAXDC + 1;
+    }
 
-    // Enable Timer overflow interrupts
-    TIMSK0 = (1 << TOIE0);
-    TIMSK1 = (1 << TOIE1);
-    TIMSK2 = (1 << TOIE2);
+    // Enable the one-shot Timer1/Timer2 overflow events, Timer0 is the scheduler tick
+    Events_Arm();
 
     sei(); /**< Enable global interrupts. */
 }
@@ -91,82 +291,138 @@ void PWM_Init()
  * This function updates the OCR (Output Compare Register) values for each timer,
  * effectively changing the duty cycle of the PWM signal. The duty cycle is mapped
  * from the `dutycycle` array (values between 0 and 100) to the range of the timers
- * (0 to 255).
+ * (0 to 255) through duty_to_ocr. Channels whose duty cycle did not change since
+ * the last call are not written.
  */
 void update_PWM()
 {
-    OCR0A = (dutycycle[0] * MAX_VALUE) / MAXDC; /**< PD6 */
-    OCR0B = (dutycycle[1] * MAX_VALUE) / MAXDC; /**< PD5 */
-    OCR1A = (dutycycle[2] * MAX_VALUE) / MAXDC; /**< PB1 */
-    OCR1B = (dutycycle[3] * MAX_VALUE) / MAXDC; /**< PB2 */
-    OCR2A = (dutycycle[4] * MAX_VALUE) / MAXDC; /**< PB3 */
+#if (USE_SOFT_PWM == 1)
+    bool soft_changed = false;
+#endif
+
+#define PWM_UPDATE(name, tccr, com, ocr, ddr, pin) \
+    { \
+        uint8_t dc = dutycycle[name]; \
+        if (dc != duty_applied[name]) \
+        { \
+            duty_applied[name] = dc; \
+            ocr = pgm_read_byte(&duty_to_ocr[dc]); \
+        } \
+    }
+    PWM_CHANNELS(PWM_UPDATE)
+#undef PWM_UPDATE
+
+#if (USE_GAMMA_PWM == 1)
+    // Gamma channels take the 0..255 value as perceptual level and fade to it
+#define PWM_GAMMA_UPDATE(name, channel) \
+    { \
+        uint8_t dc = dutycycle[name]; \
+        if (dc != duty_applied[name]) \
+        { \
+            duty_applied[name] = dc; \
+            GammaPwm_FadeTo(channel, pgm_read_byte(&duty_to_ocr[dc]), GAMMA_FADE_MS); \
+        } \
+    }
+    PWM_GAMMA_CHANNELS(PWM_GAMMA_UPDATE)
+#undef PWM_GAMMA_UPDATE
+#endif
+
+#if (USE_SOFT_PWM == 1)
+    // Software channels take the same 0..255 levels; one plane rebuild for all
+#define PWM_SOFT_UPDATE(name, channel) \
+    { \
+        uint8_t dc = dutycycle[name]; \
+        if (dc != duty_applied[name]) \
+        { \
+            duty_applied[name] = dc; \
+            SoftPwm_Set(channel, pgm_read_byte(&duty_to_ocr[dc])); \
+            soft_changed = true; \
+        } \
+    }
+    PWM_SOFT_CHANNELS(PWM_SOFT_UPDATE)
+#undef PWM_SOFT_UPDATE
+
+    if (soft_changed)
+    {
+        SoftPwm_Commit();
+    }
+#endif
 }
 
 /**
- * @brief Main program loop.
+ * @brief Duty cycle task, runs every DUTY_PERIOD_MS.
  *
- * The main loop checks if any interrupts were triggered. If an interrupt has been
- * received, it increases the duty cycle of each PWM channel by 10%, looping back
- * to 0% once the maximum (100%) is reached. It then updates the PWM signals and
- * waits for 100 milliseconds before checking again.
+ * Takes the pending events. For each event received, it increases the duty
+ * cycle of each PWM channel by 10%, looping back to 0% once the maximum (100%)
+ * is reached. It then updates the PWM signals and re-arms the sources. Without
+ * any source (gamma and software PWM both on) it steps once per call.
  */
-int main(void)
+void Duty_Task(void)
 {
-    PWM_Init();
+    uint8_t pending = Events_Take();
 
-    while (1)
+    if (EVT_SOURCES == 0U)
     {
-        for (uint8_t i = 0; i < 3; i++)
+        pending = 1U;
+    }
+
+    while (pending != 0U)
+    {
+        for (uint8_t j = 0; j < PWM_CHANNEL_COUNT; j++)
         {
-            if (intrpt_rcvd[i])
-            {
-                for (uint8_t j = 0; j < 5; j++)
-                {
-                    dutycycle[j] += 10;
-                    if (dutycycle[j] > MAXDC)
-                        dutycycle[j] = MINDC;
-                }
-                intrpt_rcvd[i] = false;
-            }
+            dutycycle[j] += 10;
+            if (dutycycle[j] > MAXDC)
+                dutycycle[j] = MINDC;
         }
-
-        update_PWM();
-
-        _delay_ms(100);
+        pending &= (uint8_t)(pending - 1U); /**< Clear the lowest event bit */
     }
 
-    return 0;
+    update_PWM();
+    Events_Arm();
 }
 
 /**
- * @brief Timer0 Overflow Interrupt Service Routine.
+ * @brief Main program.
  *
- * This ISR sets the flag indicating that Timer0 has overflowed, triggering a change
- * in the PWM duty cycle.
+ * Starts the PWM outputs and the scheduler. The CPU sleeps in idle mode
+ * whenever no task is due.
  */
-ISR(TIMER0_OVF_vect)
+int main(void)
 {
-    intrpt_rcvd[0] = true;
+    PWM_Init();
+    Sched_Init();
+    (void)Sched_Add(Duty_Task, DUTY_PERIOD_MS, 0U);
+    Sched_Run();
+
+    return 0;
 }
 
+#if (USE_GAMMA_PWM == 0)
 /**
  * @brief Timer1 Overflow Interrupt Service Routine.
  *
- * This ISR sets the flag indicating that Timer1 has overflowed, triggering a change
- * in the PWM duty cycle.
+ * This ISR raises the Timer1 event, triggering a change in the PWM duty cycle,
+ * and disables itself until Events_Arm().
  */
 ISR(TIMER1_OVF_vect)
 {
-    intrpt_rcvd[1] = true;
+    TIMSK1 &= (uint8_t)~(1 << TOIE1);
+    events |= EVT_TIMER1_OVF;
+    event_count[0]++;
 }
+#endif
 
+#if (USE_SOFT_PWM == 0)
 /**
  * @brief Timer2 Overflow Interrupt Service Routine.
  *
- * This ISR sets the flag indicating that Timer2 has overflowed, triggering a change
- * in the PWM duty cycle.
+ * This ISR raises the Timer2 event, triggering a change in the PWM duty cycle,
+ * and disables itself until Events_Arm().
  */
 ISR(TIMER2_OVF_vect)
 {
-    intrpt_rcvd[2] = true;
+    TIMSK2 &= (uint8_t)~(1 << TOIE2);
+    events |= EVT_TIMER2_OVF;
+    event_count[1]++;
 }
+#endif
@@ -0,0 +1,24 @@
+/**
+ * @file soft_pwm_config.h
+ * @brief Ports driven by AVR_Common/soft_pwm.c in this project
+ *
+ * Row 0: PB3, which lost its Timer2 compare output to the engine.
+ * Row 1: PC0..PC5.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#ifndef SOFT_PWM_CONFIG_H
+#define SOFT_PWM_CONFIG_H
+
+#define SOFT_PWM_PORTS(X) \
+    X(PORTB, DDRB, (1U << PORTB3)) \
+    X(PORTC, DDRC, 0x3FU)
+
+/** Uncomment to see every ISR as a high pulse on PB0 */
+/* #define SOFT_PWM_PROFILE_PORT  PORTB */
+/* #define SOFT_PWM_PROFILE_DDR   DDRB */
+/* #define SOFT_PWM_PROFILE_PIN   PORTB0 */
+
+#endif /* SOFT_PWM_CONFIG_H */
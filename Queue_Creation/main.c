@@ -23,6 +23,15 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "uart_log.h"
+#include "dlog.h"
+#include "rtos_profile.h"
+#include "rtos_static.h"
+#include "board.h"
+#include "latency_bench.h"
+#include "stream_buffer.h"
+#include "policy_queue.h"
+#include "worker_pool.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
@@ -30,6 +39,35 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/* Set to 1 to run Common/latency_bench.c instead of the demo tasks */
+#ifndef RUN_LATENCY_BENCH
+#define RUN_LATENCY_BENCH   0U
+#endif
+
+/* Set to 1 to run the Common/worker_pool.c throughput sweep instead */
+#ifndef RUN_WORKER_POOL_BENCH
+#define RUN_WORKER_POOL_BENCH  0U
+#endif
+
+/* Number of receiver tasks sharing xQueue */
+#ifndef RECEIVER_WORKERS
+#define RECEIVER_WORKERS    1U
+#endif
+
+/* What vSenderTask does when the queue is full, see Common/policy_queue.h */
+#ifndef QUEUE_OVERFLOW_POLICY
+#define QUEUE_OVERFLOW_POLICY  QUEUE_POLICY_BLOCK
+#endif
+/* xQueueOverwrite() only works on a single-slot queue */
+#define QUEUE_LENGTH        ((QUEUE_OVERFLOW_POLICY == QUEUE_POLICY_OVERWRITE) ? 1U : 5U)
+
+/* Set to 1 to add the TIM2 triggered ADC1 (PA0) sampling pipeline */
+#ifndef USE_ISR_SAMPLING
+#define USE_ISR_SAMPLING    0U
+#endif
+#define SAMPLE_RATE_HZ      1000U   /* ADC trigger rate from TIM2 */
+#define SAMPLE_BLOCK        32U     /* Samples handed to the task at once */
+#define SAMPLE_STREAM_SIZE  (4U * SAMPLE_BLOCK * sizeof(uint16_t))
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -37,15 +75,29 @@
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
-UART_HandleTypeDef huart2;
 QueueHandle_t xQueue;
+RTOS_QUEUE_DEFINE(xQueue, QUEUE_LENGTH, sizeof(int));
+PolicyQueue_t xSendQueue;
+RTOS_TASK_DEFINE(xSenderTask, 128);
+RTOS_TASK_ARRAY_DEFINE(xReceiverTask, RECEIVER_WORKERS, 128);
+volatile uint32_t ulWorkerJobs[RECEIVER_WORKERS];   /* Values taken by each receiver */
+#if (USE_ISR_SAMPLING == 1U)
+ADC_HandleTypeDef hadc1;
+TIM_HandleTypeDef htim2;
+StreamBufferHandle_t xSampleStream;
+RTOS_STREAM_BUFFER_DEFINE(xSampleStream, SAMPLE_STREAM_SIZE, SAMPLE_BLOCK * sizeof(uint16_t));
+RTOS_TASK_DEFINE(xSampleTask, 192);
+volatile uint32_t ulSampleOverruns;   /* Samples lost because the stream was full */
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
-void SystemClock_Config(void);
-static void MX_GPIO_Init(void);
-static void MX_USART2_UART_Init(void);
 void vSenderTask(void *pvParameters);
 void vReceiverTask(void *pvParameters);
+#if (USE_ISR_SAMPLING == 1U)
+static void MX_ADC1_Init(void);
+static void MX_TIM2_Init(void);
+void vSampleTask(void *pvParameters);
+#endif
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
@@ -62,18 +114,39 @@ int main(void)
   /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
   HAL_Init();
   SystemClock_Config();
-  MX_GPIO_Init();
-  MX_USART2_UART_Init();
+  Board_GpioInit();
+  Board_Usart2Init();
+  UartLog_Init(&huart2);
 
+#if (RUN_LATENCY_BENCH == 1U)
+  LatencyBench_Start();
+#elif (RUN_WORKER_POOL_BENCH == 1U)
+  WorkerPool_Start();
+#else
   /* Create FreeRTOS queue */
-  xQueue = xQueueCreate(5, sizeof(int));
+  xQueue = RTOS_QUEUE_CREATE(xQueue);
   if (xQueue == NULL) {
     printf("Queue creation failed \r\n");
   }
+  PolicyQueue_Init(&xSendQueue, xQueue, sizeof(int), QUEUE_OVERFLOW_POLICY, pdMS_TO_TICKS(1000));
 
   /* Create FreeRTOS tasks */
-  xTaskCreate(vSenderTask, "Sender Task", 128, 100, 1, NULL);
-  xTaskCreate(vReceiverTask, "Receiver Task", 128, NULL, 1, NULL);
+  RTOS_TASK_CREATE(xSenderTask, vSenderTask, "Sender Task", (void *)100, 1, NULL);
+  for (uint32_t i = 0U; i < RECEIVER_WORKERS; i++)
+  {
+    RTOS_TASK_ARRAY_CREATE(xReceiverTask, i, vReceiverTask, "Receiver Task", (void *)(uintptr_t)i, 1, NULL);
+  }
+  RtosProfile_AddQueue(xQueue);
+#if (USE_ISR_SAMPLING == 1U)
+  xSampleStream = RTOS_STREAM_BUFFER_CREATE(xSampleStream);
+  RTOS_TASK_CREATE(xSampleTask, vSampleTask, "Sample Task", NULL, 2, NULL);
+  MX_ADC1_Init();
+  MX_TIM2_Init();
+  HAL_ADC_Start_IT(&hadc1);
+  HAL_TIM_Base_Start(&htim2);
+#endif
+  RtosProfile_Start();
+#endif
 
   /* Start the FreeRTOS scheduler */
   vTaskStartScheduler();
@@ -83,74 +156,153 @@ int main(void)
   }
 }
 
+/* USER CODE BEGIN 4 */
+#if (USE_ISR_SAMPLING == 1U)
 /**
-  * @brief System Clock Configuration
+  * @brief ADC1 Initialization Function, one conversion of PA0 per TIM2 TRGO
+  * @param None
   * @retval None
   */
-void SystemClock_Config(void)
+static void MX_ADC1_Init(void)
 {
-  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
-
-  __HAL_RCC_PWR_CLK_ENABLE();
-  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
-  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
-  RCC_OscInitStruct.HSIState = RCC_HSI_ON;
-  RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
-  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
-  HAL_RCC_OscConfig(&RCC_OscInitStruct);
-
-  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
-  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
-  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
-  HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0);
+  ADC_ChannelConfTypeDef sConfig = {0};
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_ADC1_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  GPIO_InitStruct.Pin = GPIO_PIN_0;
+  GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+  hadc1.Instance = ADC1;
+  hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
+  hadc1.Init.Resolution = ADC_RESOLUTION_12B;
+  hadc1.Init.ScanConvMode = DISABLE;
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T2_TRGO;
+  hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc1.Init.NbrOfConversion = 1;
+  hadc1.Init.DMAContinuousRequests = DISABLE;
+  hadc1.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfig.Channel = ADC_CHANNEL_0;
+  sConfig.Rank = 1;
+  sConfig.SamplingTime = ADC_SAMPLETIME_84CYCLES;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* Calls the FreeRTOS API: must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY */
+  HAL_NVIC_SetPriority(ADC_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(ADC_IRQn);
 }
 
 /**
-  * @brief USART2 Initialization Function
+  * @brief TIM2 Initialization Function, update event every 1/SAMPLE_RATE_HZ
   * @param None
   * @retval None
   */
-static void MX_USART2_UART_Init(void)
+static void MX_TIM2_Init(void)
 {
-  huart2.Instance = USART2;
-  huart2.Init.BaudRate = 115200;
-  huart2.Init.WordLength = UART_WORDLENGTH_8B;
-  huart2.Init.StopBits = UART_STOPBITS_1;
-  huart2.Init.Parity = UART_PARITY_NONE;
-  huart2.Init.Mode = UART_MODE_TX_RX;
-  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
-  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
-  HAL_UART_Init(&huart2);
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+  uint32_t ulTimClk = HAL_RCC_GetPCLK1Freq();
+
+  /* APB1 timers run at twice PCLK1 when the APB1 prescaler is not 1 */
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1)
+  {
+    ulTimClk *= 2U;
+  }
+  __HAL_RCC_TIM2_CLK_ENABLE();
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = (ulTimClk / 1000000U) - 1U;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = (1000000U / SAMPLE_RATE_HZ) - 1U;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
 }
 
 /**
-  * @brief GPIO Initialization Function
-  * @param None
+  * @brief  ADC interrupt handler.
   * @retval None
   */
-static void MX_GPIO_Init(void)
+void ADC_IRQHandler(void)
 {
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  HAL_ADC_IRQHandler(&hadc1);
+}
 
-  __HAL_RCC_GPIOA_CLK_ENABLE();
+/**
+  * @brief  Conversion complete: pushes the sample and wakes the task only
+  *         once a whole block is buffered.
+  * @param  hadc: ADC handle
+  * @retval None
+  */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint16_t usSample = (uint16_t)HAL_ADC_GetValue(hadc);
 
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-  GPIO_InitStruct.Pin = GPIO_PIN_5;
-  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
-  GPIO_InitStruct.Pull = GPIO_NOPULL;
-  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-  HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+  if (xStreamBufferSendFromISR(xSampleStream, &usSample, sizeof(usSample),
+                               &xHigherPriorityTaskWoken) != sizeof(usSample))
+  {
+    ulSampleOverruns++;
+  }
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
-/* USER CODE BEGIN 4 */
-int _write(int file, char *data, int len)
+/**
+  * @brief Sample processing task, consumes SAMPLE_BLOCK samples at a time
+  * @param pvParameters: task parameters
+  * @retval None
+  */
+void vSampleTask(void *pvParameters)
 {
-    HAL_UART_Transmit(&huart2, (uint8_t *)data, len, HAL_MAX_DELAY);  // Transmit data via UART
-    return len;
+  uint16_t usBlock[SAMPLE_BLOCK];
+  uint32_t ulSum, ulBlocks = 0U;
+  uint16_t usMin, usMax;
+  size_t xCount, i;
+
+  for (;;)
+  {
+    xCount = xStreamBufferReceive(xSampleStream, usBlock, sizeof(usBlock), portMAX_DELAY)
+             / sizeof(uint16_t);
+    if (xCount == 0U)
+    {
+      continue;
+    }
+    ulSum = 0U;
+    usMin = UINT16_MAX;
+    usMax = 0U;
+    for (i = 0U; i < xCount; i++)
+    {
+      ulSum += usBlock[i];
+      usMin = (usBlock[i] < usMin) ? usBlock[i] : usMin;
+      usMax = (usBlock[i] > usMax) ? usBlock[i] : usMax;
+    }
+    /* One report per second at the default rate */
+    if ((++ulBlocks % (SAMPLE_RATE_HZ / SAMPLE_BLOCK)) == 0U)
+    {
+      DLOG("ADC avg=%u min=%u max=%u overruns=%lu \r\n", (unsigned)(ulSum / xCount),
+           (unsigned)usMin, (unsigned)usMax, (unsigned long)ulSampleOverruns);
+    }
+  }
 }
+#endif
 
 /**
   * @brief Sender task function
@@ -160,32 +312,45 @@ int _write(int file, char *data, int len)
 void vSenderTask(void *pvParameters)
 {
   int valuetosend = 0;
+  uint32_t ulReportedDrops = 0U;
   for (;;)
   {
     //valuetosend++;
-    if (xQueueSend(xQueue, &valuetosend, pdMS_TO_TICKS(1000)) == pdPASS)
+    if (PolicyQueue_Send(&xSendQueue, &valuetosend) == pdPASS)
     {
-      printf("Queue value sent successfully \r\n");
-      printf("Sent Value: %d \r\n", valuetosend);
+      DLOG("Queue value sent successfully \r\n");
+      DLOG("Sent Value: %d \r\n", valuetosend);
       valuetosend++;
     }
+    if (xSendQueue.ulDropped != ulReportedDrops)
+    {
+      ulReportedDrops = xSendQueue.ulDropped;
+      DLOG("Queue drops: %lu \r\n", (unsigned long)ulReportedDrops);
+    }
     vTaskDelay(pdMS_TO_TICKS(500));  // Delay 500ms
   }
 }
 
 /**
-  * @brief Receiver task function
-  * @param pvParameters: task parameters
+  * @brief Receiver task function, RECEIVER_WORKERS copies share xQueue
+  * @param pvParameters: worker index
   * @retval None
   */
 void vReceiverTask(void *pvParameters)
 {
+  uint32_t ulWorker = (uint32_t)(uintptr_t)pvParameters;
   int receivedvalue;
   for (;;)
   {
     if (xQueueReceive(xQueue, &receivedvalue, pdMS_TO_TICKS(1000)) == pdPASS)
     {
-      printf("Received Value: %d \r\n", receivedvalue);  // Print received value to UART
+      ulWorkerJobs[ulWorker]++;
+#if (RECEIVER_WORKERS > 1U)
+      DLOG("Worker %lu Received Value: %d (%lu total) \r\n", (unsigned long)ulWorker,
+           receivedvalue, (unsigned long)ulWorkerJobs[ulWorker]);
+#else
+      DLOG("Received Value: %d \r\n", receivedvalue);  // Print received value to UART
+#endif
       HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_5);  // Toggle LED on PA5
     }
   }
@@ -24,7 +24,14 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "event_groups.h"
 #include "stdio.h"
+#include "uart_log.h"
+#include "dlog.h"
+#include "rtos_profile.h"
+#include "rtos_static.h"
+#define BOARD_LED_PINS      0U
+#include "board.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -34,25 +41,71 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/* Signalling mechanism between vSenderTask and vReceiverTask */
+#define SYNC_SEMAPHORE        0U  /* Binary semaphore (queue object on the heap) */
+#define SYNC_NOTIFICATION     1U  /* Direct-to-task notification used as a counting semaphore */
+#define SYNC_EVENT_GROUP      2U  /* Event group: one wait covers data, config and shutdown */
+
+#ifndef SYNC_MECHANISM
+#define SYNC_MECHANISM        SYNC_SEMAPHORE
+#endif
+
+/* Set to 1 to replace the demo with the give-to-wake latency benchmark */
+#ifndef SYNC_BENCHMARK
+#define SYNC_BENCHMARK        0U
+#endif
+
+#define SYNC_BENCH_SAMPLES    1000U
+
+/* Conditions the receiver reacts to, only SYNC_EVENT_GROUP raises the last two */
+#define SYNC_EVT_DATA_READY       (1UL << 0)
+#define SYNC_EVT_CONFIG_CHANGED   (1UL << 1)
+#define SYNC_EVT_SHUTDOWN         (1UL << 2)
+#define SYNC_EVT_ALL              (SYNC_EVT_DATA_READY | SYNC_EVT_CONFIG_CHANGED | SYNC_EVT_SHUTDOWN)
+
+#define SYNC_CONFIG_EVERY     10U   /* Sender raises CONFIG_CHANGED every N gives */
+#ifndef SYNC_SHUTDOWN_AFTER
+#define SYNC_SHUTDOWN_AFTER   0U    /* Gives before SHUTDOWN, 0 runs forever */
+#endif
+#define SYNC_REPORT_EVERY     20U   /* Receiver prints its wakeup stats every N data events */
 
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
+#if (SYNC_MECHANISM == SYNC_NOTIFICATION)
+#define SYNC_GIVE()           ((void)xTaskNotifyGive(xReceiverTaskHandle))
+#define SYNC_TAKE(ticks)      (ulTaskNotifyTake(pdFALSE, (ticks)) != 0U)
+#elif (SYNC_MECHANISM == SYNC_EVENT_GROUP)
+#define SYNC_GIVE()           ((void)xEventGroupSetBits(xSyncEvents, SYNC_EVT_DATA_READY))
+#define SYNC_TAKE(ticks)      ((xEventGroupWaitBits(xSyncEvents, SYNC_EVT_DATA_READY, pdTRUE, \
+                                                    pdFALSE, (ticks)) & SYNC_EVT_DATA_READY) != 0U)
+#else
+#define SYNC_GIVE()           ((void)xSemaphoreGive(xSemaphore))
+#define SYNC_TAKE(ticks)      (xSemaphoreTake(xSemaphore, (ticks)) == pdTRUE)
+#endif
 
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
-UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN PV */
+#if (SYNC_MECHANISM == SYNC_SEMAPHORE)
 SemaphoreHandle_t xSemaphore;
+RTOS_BINARY_SEMAPHORE_DEFINE(xSemaphore);
+#elif (SYNC_MECHANISM == SYNC_EVENT_GROUP)
+EventGroupHandle_t xSyncEvents;
+RTOS_EVENT_GROUP_DEFINE(xSyncEvents);
+#endif
+TaskHandle_t xReceiverTaskHandle;
+RTOS_TASK_DEFINE(xSenderTask, 128);
+RTOS_TASK_DEFINE(xReceiverTask, 128);
+size_t xSyncRamBytes;                 /* RAM taken by the sync object */
+volatile uint32_t ulGiveCycles;       /* DWT timestamp taken just before the give */
+volatile uint32_t ulReceiverWakeups;  /* Times the receiver returned from its wait */
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
-void SystemClock_Config(void);
-static void MX_GPIO_Init(void);
-static void MX_USART2_UART_Init(void);
 /* USER CODE BEGIN PFP */
 void vSenderTask(void *pvParameters);
 void vReceiverTask(void *pvParameters);
@@ -60,6 +113,16 @@ void vReceiverTask(void *pvParameters);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+/**
+  * @brief  Enables the DWT cycle counter used to timestamp give and wake.
+  * @retval None
+  */
+static void DWT_CycleCounterInit(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
 
 /* USER CODE END 0 */
 
@@ -91,17 +154,49 @@ int main(void)
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
-  MX_GPIO_Init();
-  MX_USART2_UART_Init();
+  Board_GpioInit();
+  Board_Usart2Init();
   /* USER CODE BEGIN 2 */
-  xSemaphore=xSemaphoreCreateBinary();
+  UartLog_Init(&huart2);
+  DWT_CycleCounterInit();
+#if (SYNC_MECHANISM == SYNC_SEMAPHORE)
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+  xSyncRamBytes = sizeof(StaticSemaphore_t);
+#else
+  xSyncRamBytes = xPortGetFreeHeapSize();
+#endif
+  xSemaphore=RTOS_BINARY_SEMAPHORE_CREATE(xSemaphore);
   if(xSemaphore==NULL)
   {
 	  printf("failed to create a semaphore \r\n");
 	  return NULL;
   }
-  xTaskCreate(vSenderTask,"Sender Task",128,NULL,1,NULL);
-  xTaskCreate(vReceiverTask,"Receiver Task",128,NULL,1,NULL);
+#if (configSUPPORT_STATIC_ALLOCATION == 0)
+  xSyncRamBytes -= xPortGetFreeHeapSize();
+#endif
+#elif (SYNC_MECHANISM == SYNC_EVENT_GROUP)
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+  xSyncRamBytes = sizeof(StaticEventGroup_t);
+#else
+  xSyncRamBytes = xPortGetFreeHeapSize();
+#endif
+  xSyncEvents=RTOS_EVENT_GROUP_CREATE(xSyncEvents);
+  if(xSyncEvents==NULL)
+  {
+	  printf("failed to create the event group \r\n");
+	  Error_Handler();
+  }
+#if (configSUPPORT_STATIC_ALLOCATION == 0)
+  xSyncRamBytes -= xPortGetFreeHeapSize();
+#endif
+#else
+  /* The notification value lives in the receiver's TCB: no extra allocation */
+  xSyncRamBytes = 0U;
+#endif
+  RTOS_TASK_CREATE(xSenderTask,vSenderTask,"Sender Task",NULL,1,NULL);
+  /* In the benchmark the receiver pre-empts the sender on every give */
+  RTOS_TASK_CREATE(xReceiverTask,vReceiverTask,"Receiver Task",NULL,1+SYNC_BENCHMARK,&xReceiverTaskHandle);
+  RtosProfile_Start();
   vTaskStartScheduler();
   /* USER CODE END 2 */
 
@@ -116,124 +211,108 @@ int main(void)
   /* USER CODE END 3 */
 }
 
-/**
-  * @brief System Clock Configuration
-  * @retval None
-  */
-void SystemClock_Config(void)
-{
-  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
-
-  /** Configure the main internal regulator output voltage
-  */
-  __HAL_RCC_PWR_CLK_ENABLE();
-  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
-
-  /** Initializes the RCC Oscillators according to the specified parameters
-  * in the RCC_OscInitTypeDef structure.
-  */
-  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
-  RCC_OscInitStruct.HSIState = RCC_HSI_ON;
-  RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
-  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
-  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
-  {
-    Error_Handler();
-  }
-
-  /** Initializes the CPU, AHB and APB buses clocks
-  */
-  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
-                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
-  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
-  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
-
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK)
-  {
-    Error_Handler();
-  }
-}
-
-/**
-  * @brief USART2 Initialization Function
-  * @param None
-  * @retval None
-  */
-static void MX_USART2_UART_Init(void)
+/* USER CODE BEGIN 4 */
+#if (SYNC_BENCHMARK == 1U)
+void vSenderTask(void *pvParameters)
 {
-
-  /* USER CODE BEGIN USART2_Init 0 */
-
-  /* USER CODE END USART2_Init 0 */
-
-  /* USER CODE BEGIN USART2_Init 1 */
-
-  /* USER CODE END USART2_Init 1 */
-  huart2.Instance = USART2;
-  huart2.Init.BaudRate = 115200;
-  huart2.Init.WordLength = UART_WORDLENGTH_8B;
-  huart2.Init.StopBits = UART_STOPBITS_1;
-  huart2.Init.Parity = UART_PARITY_NONE;
-  huart2.Init.Mode = UART_MODE_TX_RX;
-  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
-  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
-  if (HAL_UART_Init(&huart2) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  /* USER CODE BEGIN USART2_Init 2 */
-
-  /* USER CODE END USART2_Init 2 */
-
+	for(;;)
+	{
+		/* Let the receiver block again before the next timestamped give */
+		vTaskDelay(1);
+		ulGiveCycles = DWT->CYCCNT;
+		SYNC_GIVE();
+	}
 }
-
-/**
-  * @brief GPIO Initialization Function
-  * @param None
-  * @retval None
-  */
-static void MX_GPIO_Init(void)
+void vReceiverTask(void *pvParameters)
 {
-/* USER CODE BEGIN MX_GPIO_Init_1 */
-/* USER CODE END MX_GPIO_Init_1 */
-
-  /* GPIO Ports Clock Enable */
-  __HAL_RCC_GPIOA_CLK_ENABLE();
+	uint32_t ulLatency, ulMin = UINT32_MAX, ulMax = 0U, ulCount = 0U;
+	uint64_t ullSum = 0U;
 
-/* USER CODE BEGIN MX_GPIO_Init_2 */
-/* USER CODE END MX_GPIO_Init_2 */
-}
-
-/* USER CODE BEGIN 4 */
-int _write(int file, char *data, int len)
-{
-    HAL_UART_Transmit(&huart2, (uint8_t *)data, len, HAL_MAX_DELAY);  // Transmit data via UART
-    return len;
+	for(;;)
+	{
+		if(SYNC_TAKE(portMAX_DELAY))
+		{
+			ulLatency = DWT->CYCCNT - ulGiveCycles;
+			ulMin = (ulLatency < ulMin) ? ulLatency : ulMin;
+			ulMax = (ulLatency > ulMax) ? ulLatency : ulMax;
+			ullSum += ulLatency;
+			if(++ulCount == SYNC_BENCH_SAMPLES)
+			{
+				printf("%s give-to-wake cycles: min %lu avg %lu max %lu, sync RAM %u bytes \r\n",
+				       (SYNC_MECHANISM == SYNC_NOTIFICATION) ? "notify" :
+				       (SYNC_MECHANISM == SYNC_EVENT_GROUP) ? "event group" : "semaphore",
+				       ulMin, (uint32_t)(ullSum / ulCount), ulMax, (unsigned)xSyncRamBytes);
+				ulMin = UINT32_MAX;
+				ulMax = 0U;
+				ullSum = 0U;
+				ulCount = 0U;
+			}
+		}
+	}
 }
+#else
 void vSenderTask(void *pvParameters)
 {
+	uint32_t ulRound = 0U;
+
 	for(;;)
 	{
-		printf("sender task:giving the semaphore \r\n");
-		xSemaphoreGive(xSemaphore);
+		DLOG("sender task:giving the semaphore \r\n");
+		ulGiveCycles = DWT->CYCCNT;
+		SYNC_GIVE();
+		ulRound++;
+#if (SYNC_MECHANISM == SYNC_EVENT_GROUP)
+		if((ulRound % SYNC_CONFIG_EVERY) == 0U)
+		{
+			(void)xEventGroupSetBits(xSyncEvents, SYNC_EVT_CONFIG_CHANGED);
+		}
+		if(ulRound == SYNC_SHUTDOWN_AFTER)
+		{
+			(void)xEventGroupSetBits(xSyncEvents, SYNC_EVT_SHUTDOWN);
+			vTaskDelete(NULL);
+		}
+#endif
 		vTaskDelay(pdMS_TO_TICKS(500));
 	}
 }
 void vReceiverTask(void *pvParameters)
 {
+	uint32_t ulEvents, ulLatency, ulMaxLatency = 0U, ulDataEvents = 0U;
+
 	for(;;)
 	{
-		if(xSemaphoreTake(xSemaphore,portMAX_DELAY==pdTRUE))
+		/* Blocks until signalled: no polling delay, so every wakeup has work */
+#if (SYNC_MECHANISM == SYNC_EVENT_GROUP)
+		ulEvents = xEventGroupWaitBits(xSyncEvents, SYNC_EVT_ALL, pdTRUE, pdFALSE, portMAX_DELAY);
+#else
+		/* Notification mode counts gives, so a burst is processed one by one */
+		ulEvents = SYNC_TAKE(portMAX_DELAY) ? SYNC_EVT_DATA_READY : 0U;
+#endif
+		ulReceiverWakeups++;
+		if((ulEvents & SYNC_EVT_DATA_READY) != 0U)
 		{
-		printf("Receiver Task: Semaphore taken, processing data \r\n");
+			ulLatency = DWT->CYCCNT - ulGiveCycles;
+			ulMaxLatency = (ulLatency > ulMaxLatency) ? ulLatency : ulMaxLatency;
+			DLOG("Receiver Task: Semaphore taken, processing data \r\n");
+			if((++ulDataEvents % SYNC_REPORT_EVERY) == 0U)
+			{
+				DLOG("Receiver wakeups %lu for %lu data events, latency %lu cycles (max %lu) \r\n",
+				     (unsigned long)ulReceiverWakeups, (unsigned long)ulDataEvents,
+				     (unsigned long)ulLatency, (unsigned long)ulMaxLatency);
+			}
+		}
+		if((ulEvents & SYNC_EVT_CONFIG_CHANGED) != 0U)
+		{
+			DLOG("Receiver Task: config changed \r\n");
+		}
+		if((ulEvents & SYNC_EVT_SHUTDOWN) != 0U)
+		{
+			DLOG("Receiver Task: shutdown \r\n");
+			vTaskDelete(NULL);
 		}
-		vTaskDelay(pdMS_TO_TICKS(500));
 	}
-	vTaskDelay(pdMS_TO_TICKS(500));
 }
+#endif
 /* USER CODE END 4 */
 
 /**
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Decode the binary DLOG stream produced with DLOG_BINARY=1.
+
+Format strings are read from the .dlog_fmt section of the firmware ELF, so
+the decoder must be given the same ELF that is running on the board. Bytes
+that are not part of a valid record (boot messages, plain printf output) are
+passed through as text.
+
+Usage:
+    dlog_decode.py firmware.elf capture.bin
+    dlog_decode.py firmware.elf /dev/ttyACM0 --baud 115200
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+DLOG_SYNC = 0xD1
+DLOG_HEADER_SIZE = 6
+DLOG_MAX_ARGS = 6
+
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diuxXoc%s])")
+# Arguments travel as single 32-bit words, these need two on the target
+WIDE_MODIFIERS = ("ll", "j")
+
+
+def load_formats(elf_path):
+    """Return {address: format string} for every string in .dlog_fmt."""
+    with open(elf_path, "rb") as f:
+        section = ELFFile(f).get_section_by_name(".dlog_fmt")
+        if section is None:
+            sys.exit("%s has no .dlog_fmt section, build with DLOG_BINARY=1" % elf_path)
+        base = section["sh_addr"]
+        data = section.data()
+
+    formats = {}
+    offset = 0
+    while offset < len(data):
+        end = data.find(b"\0", offset)
+        if end < 0:
+            end = len(data)
+        if end > offset:
+            formats[base + offset] = data[offset:end].decode("ascii", "replace")
+        # Skip the terminator and any alignment padding
+        offset = end + 1
+        while offset < len(data) and data[offset] == 0:
+            offset += 1
+
+    wide = [fmt for fmt in formats.values()
+            if any(m.group(2) in WIDE_MODIFIERS for m in CONVERSION.finditer(fmt))]
+    if wide:
+        sys.exit("64-bit conversions are not supported by DLOG, use a 32-bit "
+                 "type or printf() for:\n" + "\n".join("  %r" % fmt for fmt in wide))
+    return formats
+
+
+def render(fmt, args):
+    """Apply the raw 32-bit arguments to a printf format string."""
+    values = iter(args)
+
+    def convert(match):
+        flags, _, conv = match.groups()
+        if conv == "%":
+            return "%"
+        if conv == "s":
+            next(values, 0)
+            return "<str>"
+        raw = next(values, 0)
+        if conv in "di":
+            raw = struct.unpack("<i", struct.pack("<I", raw))[0]
+        return ("%" + flags + conv) % raw
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(stream, formats, out, follow=False):
+    buf = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            if follow:
+                continue
+            break
+        buf += chunk
+        while buf:
+            if buf[0] != DLOG_SYNC:
+                out.write(chr(buf.pop(0)))
+                continue
+            if len(buf) < DLOG_HEADER_SIZE:
+                break
+            nargs = buf[1]
+            fmt_id = struct.unpack_from("<I", buf, 2)[0]
+            if nargs > DLOG_MAX_ARGS or fmt_id not in formats:
+                out.write(chr(buf.pop(0)))
+                continue
+            size = DLOG_HEADER_SIZE + 4 * nargs
+            if len(buf) < size:
+                break
+            args = struct.unpack_from("<%dI" % nargs, buf, DLOG_HEADER_SIZE)
+            out.write(render(formats[fmt_id], args))
+            del buf[:size]
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF built with DLOG_BINARY=1")
+    parser.add_argument("source", help="capture file or serial port")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    formats = load_formats(args.elf)
+    if args.source.startswith("/dev/") or args.source.upper().startswith("COM"):
+        import serial
+        stream = serial.Serial(args.source, args.baud, timeout=0.1)
+        follow = True
+    else:
+        stream = open(args.source, "rb")
+        follow = False
+    try:
+        decode(stream, formats, sys.stdout, follow)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
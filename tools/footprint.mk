@@ -0,0 +1,45 @@
+# Stack and RAM/flash footprint report for the STM32 demos, see footprint.py.
+#
+# Each demo's makefile.targets includes this file, and the makefile that
+# STM32CubeIDE generates in Debug/ or Release/ includes makefile.targets.
+# Add -fstack-usage -fcallgraph-info=su to the project's compiler flags
+# (C/C++ Build > Settings > MCU GCC Compiler > Miscellaneous), build, then:
+#   make footprint
+#   make footprint FOOTPRINT_STACK_MARGIN=25 FOOTPRINT_MAX_RAM=65536
+# With FOOTPRINT_GATE=1 the report runs after every link and a limit that is
+# exceeded fails the build.
+
+FOOTPRINT_TOOL  := $(dir $(lastword $(MAKEFILE_LIST)))footprint.py
+FOOTPRINT_ROOT  ?= ..
+FOOTPRINT_SRCS  ?= $(wildcard $(FOOTPRINT_ROOT)/main.c $(FOOTPRINT_ROOT)/Core/Src/main.c \
+                              $(FOOTPRINT_ROOT)/Core/Inc/FreeRTOSConfig.h \
+                              $(FOOTPRINT_ROOT)/../Common/*.c $(FOOTPRINT_ROOT)/../Common/*.h)
+
+# STM32F446RE: 512 KiB flash, 128 KiB SRAM
+FOOTPRINT_MAX_FLASH    ?= 524288
+FOOTPRINT_MAX_RAM      ?= 131072
+FOOTPRINT_STACK_MARGIN ?= 10
+FOOTPRINT_GATE         ?= 0
+
+FOOTPRINT_ARGS := --build . $(addprefix --src ,$(FOOTPRINT_SRCS)) \
+                  --max-flash $(FOOTPRINT_MAX_FLASH) --max-ram $(FOOTPRINT_MAX_RAM) \
+                  --stack-margin $(FOOTPRINT_STACK_MARGIN) $(FOOTPRINT_EXTRA)
+
+# The generated makefile names its link output $(BUILD_ARTIFACT) (CubeIDE
+# 1.4 and newer); set FOOTPRINT_ELF in makefile.targets for older ones.
+FOOTPRINT_ELF ?= $(BUILD_ARTIFACT)
+
+ifneq ($(strip $(FOOTPRINT_ELF)),)
+# Depends on the link output, so with -j it still runs after the link
+footprint: $(FOOTPRINT_ELF)
+	python3 $(FOOTPRINT_TOOL) $(FOOTPRINT_ARGS)
+else
+footprint:
+	@echo "footprint: set FOOTPRINT_ELF to the linked .elf" >&2; exit 1
+endif
+
+ifeq ($(FOOTPRINT_GATE),1)
+main-build: footprint
+endif
+
+.PHONY: footprint
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+"""Worst-case task stack and static RAM/flash report for the STM32 demos.
+
+Needs a build compiled with -fstack-usage -fcallgraph-info=su (GCC 10 or
+newer), which leaves a .su and a .ci file next to every object. The call
+graphs of all objects are merged and walked from each task entry function;
+the deepest path plus the context switch frame is compared with the stack
+depth the task is created with. Task entry points and depths are read from
+RTOS_TASK_DEFINE / RTOS_TASK_CREATE / xTaskCreate in the given .c sources
+(headers given with --src only provide #defines), or by hand with --task.
+
+GCC names static functions "<file>:<name>" in the .ci graph; task entries
+are matched by name, and by source file when several files define it. A
+task created in a source that was compiled into this build but that cannot
+be found in the graph is an error, sources without a .ci file are skipped.
+
+Flash and RAM are summed per object file from its allocated sections:
+text and rodata go to flash, data to flash and RAM, bss to RAM only.
+
+Exits with status 1 when a task stack or a RAM/flash limit is exceeded, or
+when a task entry point cannot be resolved.
+
+Usage:
+    footprint.py --build Debug --src Semaphore/main.c --src Common/uart_log.c
+    footprint.py --build Debug --task vWorker=256 --max-ram 65536 --stack-margin 20
+"""
+
+import argparse
+import os
+import re
+import sys
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+
+# Cortex-M4F worst case on a context switch: 26 words of FPU exception frame
+# pushed by hardware plus r4-r11, lr and s16-s31 saved by the port.
+DEFAULT_SWITCH_FRAME = 204
+WORD_SIZE = 4
+
+CI_NODE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"')
+CI_EDGE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+CI_STACK = re.compile(r"(\d+) bytes \(([a-z,]+)\)")
+
+DEFINE = re.compile(r"^\s*#\s*define\s+(\w+)\s+(.+?)\s*(?:/[/*].*)?$", re.M)
+TASK_DEFINE = re.compile(r"RTOS_TASK_DEFINE\(\s*(\w+)\s*,\s*([^)]+)\)")
+TASK_ARRAY_DEFINE = re.compile(r"RTOS_TASK_ARRAY_DEFINE\(\s*(\w+)\s*,\s*[^,]+,\s*([^)]+)\)")
+TASK_CREATE = re.compile(r"RTOS_TASK_CREATE\(\s*(\w+)\s*,\s*(\w+)")
+TASK_ARRAY_CREATE = re.compile(r"RTOS_TASK_ARRAY_CREATE\(\s*(\w+)\s*,\s*[^,]+,\s*(\w+)")
+XTASK_CREATE = re.compile(r"xTaskCreate\(\s*(\w+)\s*,\s*\"[^\"]*\"\s*,\s*([^,]+),")
+
+
+def load_callgraph(build_dir):
+    """Return ({title: (bytes, qualifier)}, {title: set(callees)}, {built source stems})."""
+    frames = {}
+    calls = {}
+    built = set()
+    for root, _, files in os.walk(build_dir):
+        for name in files:
+            if not name.endswith(".ci"):
+                continue
+            built.add(name[:-3])
+            with open(os.path.join(root, name)) as f:
+                text = f.read()
+            for title, label in CI_NODE.findall(text):
+                match = CI_STACK.search(label)
+                if match:
+                    size = int(match.group(1))
+                    # Same static name in two files: keep the larger frame
+                    if title not in frames or frames[title][0] < size:
+                        frames[title] = (size, match.group(2))
+            for src, dst in CI_EDGE.findall(text):
+                calls.setdefault(src, set()).add(dst)
+    return frames, calls, built
+
+
+def resolve(function, origin, frames):
+    """Return the call graph title of a task entry, None if not found.
+
+    Raises ValueError when the name is static in several files and origin
+    does not tell which one is meant.
+    """
+    if function in frames:
+        return function
+    candidates = [title for title in frames if title.endswith(":" + function)]
+    if len(candidates) > 1:
+        same_file = [title for title in candidates
+                     if os.path.basename(title.rpartition(":")[0]) == origin]
+        if len(same_file) != 1:
+            raise ValueError("%s is defined in %s" % (function, ", ".join(sorted(candidates))))
+        candidates = same_file
+    return candidates[0] if candidates else None
+
+
+def worst_stack(function, frames, calls, memo, active):
+    """Deepest stack below function as (bytes, unknown callees, flags)."""
+    if function in memo:
+        return memo[function]
+    if function in active:
+        return 0, set(), {"recursion via %s" % function}
+    if function == "__indirect_call":
+        return 0, set(), {"indirect call"}
+    if function not in frames:
+        return 0, {function}, set()
+
+    size, qualifier = frames[function]
+    flags = set()
+    if "dynamic" in qualifier and "bounded" not in qualifier:
+        flags.add("unbounded alloca in %s" % function)
+    active.add(function)
+    deepest, unknown = 0, set()
+    for callee in sorted(calls.get(function, ())):
+        depth, callee_unknown, callee_flags = worst_stack(callee, frames, calls, memo, active)
+        deepest = max(deepest, depth)
+        unknown |= callee_unknown
+        flags |= callee_flags
+    active.discard(function)
+    memo[function] = (size + deepest, unknown, flags)
+    return memo[function]
+
+
+def evaluate(expr, defines, depth=0):
+    """Evaluate a stack depth expression using simple object-like #defines."""
+    def expand(match):
+        word = match.group(0)
+        if word in defines and depth < 8:
+            value = evaluate(defines[word], defines, depth + 1)
+            return str(value) if value is not None else word
+        return word
+
+    text = re.sub(r"\b[A-Za-z_]\w*\b", expand, expr)
+    text = re.sub(r"\b(\d+)[uUlL]+\b", r"\1", text)
+    text = re.sub(r"\(\s*(?:unsigned\s+\w+|uint\d+_t|UBaseType_t|size_t)\s*\)", "", text)
+    if not re.fullmatch(r"[\d\s()+\-*/]+", text):
+        return None
+    return int(eval(text.replace("/", "//")))
+
+
+def find_tasks(sources):
+    """Return [(function, depth words or None, origin)] created in sources."""
+    defines, depths, tasks = {}, {}, []
+    texts = []
+    for path in sources:
+        with open(path) as f:
+            texts.append((path, f.read()))
+    for _, text in texts:
+        defines.update(DEFINE.findall(text))
+    for _, text in texts:
+        for name, expr in TASK_DEFINE.findall(text) + TASK_ARRAY_DEFINE.findall(text):
+            depths[name] = evaluate(expr, defines)
+    for path, text in texts:
+        # Headers only contribute #defines, their examples are not tasks
+        if path.endswith(".h"):
+            continue
+        origin = os.path.basename(path)
+        text = re.sub(r"^\s*#\s*define.*$", "", text, flags=re.M)
+        for name, function in TASK_CREATE.findall(text) + TASK_ARRAY_CREATE.findall(text):
+            tasks.append((function, depths.get(name), origin))
+        for function, expr in XTASK_CREATE.findall(text):
+            tasks.append((function, evaluate(expr, defines), origin))
+    return tasks
+
+
+def section_sizes(build_dir):
+    """Return {object: [flash, data, bss]} for every .o under build_dir."""
+    sizes = {}
+    for root, _, files in os.walk(build_dir):
+        for name in sorted(files):
+            if not name.endswith(".o"):
+                continue
+            entry = [0, 0, 0]
+            with open(os.path.join(root, name), "rb") as f:
+                for section in ELFFile(f).iter_sections():
+                    flags = section["sh_flags"]
+                    if not flags & SH_FLAGS.SHF_ALLOC:
+                        continue
+                    if not flags & SH_FLAGS.SHF_WRITE:
+                        entry[0] += section["sh_size"]
+                    elif section["sh_type"] == "SHT_NOBITS":
+                        entry[2] += section["sh_size"]
+                    else:
+                        entry[1] += section["sh_size"]
+            sizes[os.path.relpath(os.path.join(root, name), build_dir)] = entry
+    return sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--build", required=True, help="build directory with .o/.su/.ci files")
+    parser.add_argument("--src", action="append", default=[], help="source to scan for task creation")
+    parser.add_argument("--task", action="append", default=[], metavar="FUNC=WORDS",
+                        help="extra task entry point and its stack depth in words")
+    parser.add_argument("--switch-frame", type=int, default=DEFAULT_SWITCH_FRAME,
+                        help="bytes reserved for the context switch frame (default %(default)s)")
+    parser.add_argument("--stack-margin", type=int, default=0,
+                        help="required free stack in percent of the depth (default 0)")
+    parser.add_argument("--max-ram", type=int, help="fail above this many bytes of data + bss")
+    parser.add_argument("--max-flash", type=int, help="fail above this many bytes of text + rodata + data")
+    args = parser.parse_args()
+
+    frames, calls, built = load_callgraph(args.build)
+    if not frames:
+        sys.exit("no .ci files under %s, build with -fstack-usage -fcallgraph-info=su" % args.build)
+
+    tasks = find_tasks(args.src)
+    for item in args.task:
+        function, _, words = item.partition("=")
+        tasks.append((function, int(words, 0) if words else None, "--task"))
+
+    failures = []
+    print("%-24s %-18s %8s %8s %6s  %s" % ("task", "source", "worst", "stack", "used", "notes"))
+    for function, words, origin in tasks:
+        # Shared sources are scanned whole, skip the modules this build left out
+        if origin != "--task" and os.path.splitext(origin)[0] not in built:
+            continue
+        try:
+            title = resolve(function, origin, frames)
+        except ValueError as error:
+            failures.append("task entry %s: %s" % (function, error))
+            continue
+        if title is None:
+            print("%-24s %-18s %8s %8s %6s  %s" % (function, origin, "?", "?", "", "not in call graph"))
+            failures.append("task entry %s (%s) not found in the call graph" % (function, origin))
+            continue
+        depth, unknown, flags = worst_stack(title, frames, calls, {}, set())
+        need = depth + args.switch_frame
+        notes = sorted(flags)
+        if unknown:
+            notes.append("no stack info: " + ", ".join(sorted(unknown)))
+        if words is None:
+            print("%-24s %-18s %8d %8s %6s  %s" % (function, origin, need, "?", "", "; ".join(notes)))
+            continue
+        size = words * WORD_SIZE
+        used = (100 * need) // size
+        print("%-24s %-18s %8d %8d %5d%%  %s" % (function, origin, need, size, used, "; ".join(notes)))
+        if need * 100 > size * (100 - args.stack_margin):
+            failures.append("%s needs %d of %d stack bytes (margin %d%%)"
+                            % (function, need, size, args.stack_margin))
+
+    sizes = section_sizes(args.build)
+    total = [0, 0, 0]
+    print()
+    print("%-40s %8s %8s %8s" % ("object", "flash", "data", "bss"))
+    for name, (flash, data, bss) in sorted(sizes.items()):
+        print("%-40s %8d %8d %8d" % (name, flash, data, bss))
+        total = [total[0] + flash, total[1] + data, total[2] + bss]
+    flash_total = total[0] + total[1]
+    ram_total = total[1] + total[2]
+    print("%-40s %8d %8d %8d" % ("total", total[0], total[1], total[2]))
+    print("flash %d bytes, static RAM %d bytes (objects only, libraries not included)"
+          % (flash_total, ram_total))
+
+    if args.max_flash is not None and flash_total > args.max_flash:
+        failures.append("flash %d > %d bytes" % (flash_total, args.max_flash))
+    if args.max_ram is not None and ram_total > args.max_ram:
+        failures.append("static RAM %d > %d bytes" % (ram_total, args.max_ram))
+
+    for failure in failures:
+        print("FAIL: " + failure, file=sys.stderr)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
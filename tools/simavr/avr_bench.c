@@ -0,0 +1,435 @@
+/**
+ * @file avr_bench.c
+ * @brief Cycle accurate benchmark and regression check of the AVR firmware
+ *        under simavr
+ *
+ * Loads an ELF, applies fixed ADC input voltages and runs it for a given
+ * simulated time. During the measurement window it records:
+ *
+ *  - for every interrupt vector: count, latency (flag raised while enabled to
+ *    first ISR instruction) and duration (first instruction to reti), in cycles;
+ *  - CPU load (cycles not spent in sleep) and busy cycles per wakeup, i.e.
+ *    per main loop pass of firmware that sleeps when idle;
+ *  - the duty cycle of every traced pin, optionally written to a VCD file.
+ *
+ * Optional limits turn the report into a regression check: the program exits
+ * with status 1 when a duty cycle is off or a latency/load limit is exceeded.
+ *
+ *   avr_bench -f fw.elf [-m atmega328p] [-F 16000000] [--ms 500] [--start-ms 100]
+ *             [--adc CH=MV]... [--pin D6]... [--duty D6=50[:1]]... [--vcd out.vcd]
+ *             [--max-latency CYCLES] [--max-load PERCENT]
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_interrupts.h"
+#include "sim_regbit.h"
+#include "sim_vcd_file.h"
+#include "avr_adc.h"
+#include "avr_ioport.h"
+
+#define BENCH_MAX_PINS     16
+#define BENCH_MAX_VECTORS  64
+#define BENCH_MAX_ADC       8
+
+/** Duty cycle measurement of one port pin */
+typedef struct
+{
+    char port;                      ///< 'B', 'C' or 'D'
+    uint8_t bit;
+    int level;                      ///< Current pin level
+    avr_cycle_count_t last;         ///< Cycle of the last edge or window start
+    avr_cycle_count_t high;         ///< High cycles inside the window
+    double expect;                  ///< Expected duty in percent, < 0 if unchecked
+    double tol;                     ///< Allowed error in percentage points
+} Bench_Pin_t;
+
+/** Timing of one interrupt vector */
+typedef struct
+{
+    avr_int_vector_t *vector;       ///< simavr vector, for its enable bit
+    avr_cycle_count_t pending;      ///< Cycle the flag was raised while enabled, 0 if none
+    avr_cycle_count_t cleared;      ///< Cycle the flag was last cleared
+    avr_cycle_count_t cleared_pending; ///< Value of pending when it was cleared
+    avr_cycle_count_t entry;        ///< Cycle of the current ISR entry
+    uint32_t count;
+    avr_cycle_count_t lat_sum, lat_max;
+    avr_cycle_count_t dur_sum, dur_max;
+} Bench_Vector_t;
+
+static avr_t *avr;
+static avr_cycle_count_t window_start;
+static int in_window;
+
+static Bench_Pin_t pins[BENCH_MAX_PINS];
+static int pin_count;
+static Bench_Vector_t vectors[BENCH_MAX_VECTORS];
+
+/**
+ * @brief Adds the high time since the last edge, clipped to the window.
+ */
+static void pin_account(Bench_Pin_t *pin, avr_cycle_count_t now)
+{
+    if (in_window && (pin->level != 0))
+    {
+        pin->high += now - pin->last;
+    }
+    pin->last = now;
+}
+
+static void pin_changed(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    Bench_Pin_t *pin = param;
+
+    (void)irq;
+    pin_account(pin, avr->cycle);
+    pin->level = (value != 0U);
+}
+
+/**
+ * @brief Flag raised or cleared. A flag raised while its interrupt is masked
+ *        is not a latency sample (the firmware may poll or clear it); a flag
+ *        cleared without the ISR running drops the sample.
+ */
+static void int_pending(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    Bench_Vector_t *vec = param;
+
+    (void)irq;
+    if (value != 0U)
+    {
+        if ((vec->pending == 0U) && avr_regbit_get(avr, vec->vector->enable))
+        {
+            vec->pending = avr->cycle;
+        }
+    }
+    else
+    {
+        /** simavr may clear the flag just before entering the ISR, keep it for that cycle */
+        vec->cleared = avr->cycle;
+        vec->cleared_pending = vec->pending;
+        vec->pending = 0U;
+    }
+}
+
+static void int_running(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    Bench_Vector_t *vec = param;
+    avr_cycle_count_t t;
+
+    (void)irq;
+    if (value != 0U)
+    {
+        vec->entry = avr->cycle;
+        if ((vec->pending == 0U) && (vec->cleared == avr->cycle))
+        {
+            vec->pending = vec->cleared_pending;
+        }
+        if (in_window && (vec->pending != 0U))
+        {
+            t = avr->cycle - vec->pending;
+            vec->lat_sum += t;
+            if (t > vec->lat_max)
+            {
+                vec->lat_max = t;
+            }
+        }
+        vec->pending = 0U;
+    }
+    else if (in_window && (vec->entry >= window_start))
+    {
+        t = avr->cycle - vec->entry;
+        vec->count++;
+        vec->dur_sum += t;
+        if (t > vec->dur_max)
+        {
+            vec->dur_max = t;
+        }
+    }
+}
+
+/**
+ * @brief Parses "D6" into a port letter and bit number.
+ */
+static int parse_pin(const char *s, char *port, uint8_t *bit)
+{
+    if ((s[0] < 'B') || (s[0] > 'D') || (s[1] < '0') || (s[1] > '7'))
+    {
+        return -1;
+    }
+    *port = s[0];
+    *bit = (uint8_t)(s[1] - '0');
+    return 0;
+}
+
+static Bench_Pin_t *add_pin(const char *s)
+{
+    Bench_Pin_t *pin;
+    char port;
+    uint8_t bit;
+    int i;
+
+    if (parse_pin(s, &port, &bit) != 0)
+    {
+        fprintf(stderr, "avr_bench: bad pin '%s', expected e.g. D6\n", s);
+        exit(2);
+    }
+    for (i = 0; i < pin_count; i++)
+    {
+        if ((pins[i].port == port) && (pins[i].bit == bit))
+        {
+            return &pins[i];
+        }
+    }
+    if (pin_count >= BENCH_MAX_PINS)
+    {
+        fprintf(stderr, "avr_bench: more than %d pins\n", BENCH_MAX_PINS);
+        exit(2);
+    }
+    pin = &pins[pin_count++];
+    pin->port = port;
+    pin->bit = bit;
+    pin->expect = -1.0;
+    return pin;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: avr_bench -f fw.elf [-m mcu] [-F hz] [--ms N] [--start-ms N]\n"
+            "                 [--adc CH=MV]... [--pin D6]... [--duty D6=50[:1]]...\n"
+            "                 [--vcd file] [--max-latency CYCLES] [--max-load PERCENT]\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *elf = NULL, *mcu = "atmega328p", *vcd_file = NULL;
+    unsigned long freq = 16000000UL;
+    double run_ms = 500.0, start_ms = 100.0, max_load = -1.0;
+    long max_latency = -1;
+    uint32_t adc_mv[BENCH_MAX_ADC];
+    int adc_set[BENCH_MAX_ADC] = {0};
+    elf_firmware_t fw;
+    avr_vcd_t vcd;
+    avr_cycle_count_t end, before, sleep_cycles = 0U, busy, window;
+    unsigned long wakeups = 0UL;
+    int state, was, i, failed = 0;
+    char name[8];
+
+    for (i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if ((strcmp(a, "-f") == 0) && v) { elf = v; i++; }
+        else if ((strcmp(a, "-m") == 0) && v) { mcu = v; i++; }
+        else if ((strcmp(a, "-F") == 0) && v) { freq = strtoul(v, NULL, 0); i++; }
+        else if ((strcmp(a, "--ms") == 0) && v) { run_ms = atof(v); i++; }
+        else if ((strcmp(a, "--start-ms") == 0) && v) { start_ms = atof(v); i++; }
+        else if ((strcmp(a, "--vcd") == 0) && v) { vcd_file = v; i++; }
+        else if ((strcmp(a, "--max-latency") == 0) && v) { max_latency = atol(v); i++; }
+        else if ((strcmp(a, "--max-load") == 0) && v) { max_load = atof(v); i++; }
+        else if ((strcmp(a, "--pin") == 0) && v) { (void)add_pin(v); i++; }
+        else if ((strcmp(a, "--adc") == 0) && v)
+        {
+            unsigned ch;
+            unsigned long mv;
+            if ((sscanf(v, "%u=%lu", &ch, &mv) != 2) || (ch >= BENCH_MAX_ADC))
+            {
+                usage();
+            }
+            adc_mv[ch] = (uint32_t)mv;
+            adc_set[ch] = 1;
+            i++;
+        }
+        else if ((strcmp(a, "--duty") == 0) && v)
+        {
+            Bench_Pin_t *pin = add_pin(v);
+            const char *eq = strchr(v, '=');
+            const char *colon = strchr(v, ':');
+            if (eq == NULL)
+            {
+                usage();
+            }
+            pin->expect = atof(eq + 1);
+            pin->tol = (colon != NULL) ? atof(colon + 1) : 1.0;
+            i++;
+        }
+        else
+        {
+            usage();
+        }
+    }
+    if ((elf == NULL) || (start_ms >= run_ms))
+    {
+        usage();
+    }
+
+    if (elf_read_firmware(elf, &fw) != 0)
+    {
+        fprintf(stderr, "avr_bench: cannot read %s\n", elf);
+        return 2;
+    }
+    avr = avr_make_mcu_by_name(mcu);
+    if (avr == NULL)
+    {
+        fprintf(stderr, "avr_bench: unknown mcu %s\n", mcu);
+        return 2;
+    }
+    avr_init(avr);
+    avr->frequency = (uint32_t)freq;
+    avr->vcc = avr->avcc = avr->aref = 5000;
+    avr_load_firmware(avr, &fw);
+
+    for (i = 0; i < BENCH_MAX_ADC; i++)
+    {
+        if (adc_set[i])
+        {
+            avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + i), adc_mv[i]);
+        }
+    }
+
+    for (i = 0; i < avr->interrupts.vector_count; i++)
+    {
+        avr_int_vector_t *vector = avr->interrupts.vectors[i];
+        avr_irq_t *irq;
+
+        if ((vector == NULL) || (vector->vector >= BENCH_MAX_VECTORS))
+        {
+            continue;
+        }
+        vectors[vector->vector].vector = vector;
+        irq = avr_get_interrupt_irq(avr, vector->vector);
+        if (irq != NULL)
+        {
+            avr_irq_register_notify(irq + AVR_INT_IRQ_PENDING, int_pending, &vectors[vector->vector]);
+            avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, int_running, &vectors[vector->vector]);
+        }
+    }
+
+    if (vcd_file != NULL)
+    {
+        avr_vcd_init(avr, vcd_file, &vcd, 1000);
+    }
+    for (i = 0; i < pin_count; i++)
+    {
+        avr_irq_t *irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(pins[i].port), pins[i].bit);
+        avr_irq_register_notify(irq, pin_changed, &pins[i]);
+        if (vcd_file != NULL)
+        {
+            snprintf(name, sizeof(name), "P%c%u", pins[i].port, pins[i].bit);
+            avr_vcd_add_signal(&vcd, irq, 1, name);
+        }
+    }
+    if (vcd_file != NULL)
+    {
+        avr_vcd_start(&vcd);
+    }
+
+    /** Settle until the window opens, then measure until the end */
+    window_start = (avr_cycle_count_t)(start_ms * (double)freq / 1000.0);
+    end = (avr_cycle_count_t)(run_ms * (double)freq / 1000.0);
+    state = cpu_Running;
+    while ((avr->cycle < end) && (state != cpu_Done) && (state != cpu_Crashed))
+    {
+        if (!in_window && (avr->cycle >= window_start))
+        {
+            in_window = 1;
+            window_start = avr->cycle;
+            for (i = 0; i < pin_count; i++)
+            {
+                pins[i].last = avr->cycle;
+            }
+        }
+        was = avr->state;
+        before = avr->cycle;
+        state = avr_run(avr);
+        if (in_window && (was == cpu_Sleeping))
+        {
+            sleep_cycles += avr->cycle - before;
+            if (avr->state != cpu_Sleeping)
+            {
+                wakeups++;
+            }
+        }
+    }
+    for (i = 0; i < pin_count; i++)
+    {
+        pin_account(&pins[i], avr->cycle);
+    }
+    if (vcd_file != NULL)
+    {
+        avr_vcd_stop(&vcd);
+    }
+
+    if ((state == cpu_Crashed) || !in_window)
+    {
+        printf("FAIL  %s: cpu %s before the window ended\n", elf,
+               (state == cpu_Crashed) ? "crashed" : "stopped");
+        return 1;
+    }
+
+    window = avr->cycle - window_start;
+    busy = window - sleep_cycles;
+    printf("%s: %.1f ms window at %lu Hz\n", elf, (double)window * 1000.0 / (double)freq, freq);
+    printf("  cpu load      %6.2f %%\n", 100.0 * (double)busy / (double)window);
+    if (wakeups != 0UL)
+    {
+        printf("  cycles/wakeup %6.0f  (%lu wakeups)\n", (double)busy / (double)wakeups, wakeups);
+    }
+    else
+    {
+        printf("  cycles/wakeup      -  (never sleeps)\n");
+    }
+    if ((max_load >= 0.0) && ((100.0 * (double)busy / (double)window) > max_load))
+    {
+        printf("FAIL  cpu load above %.2f %%\n", max_load);
+        failed = 1;
+    }
+
+    printf("  vector  count    lat avg  lat max    isr avg  isr max   load %%\n");
+    for (i = 0; i < BENCH_MAX_VECTORS; i++)
+    {
+        Bench_Vector_t *vec = &vectors[i];
+        if (vec->count == 0U)
+        {
+            continue;
+        }
+        printf("  %6d %6lu %10.1f %8lu %10.1f %8lu %8.2f\n", i, (unsigned long)vec->count,
+               (double)vec->lat_sum / vec->count, (unsigned long)vec->lat_max,
+               (double)vec->dur_sum / vec->count, (unsigned long)vec->dur_max,
+               100.0 * (double)vec->dur_sum / (double)window);
+        if ((max_latency >= 0) && (vec->lat_max > (avr_cycle_count_t)max_latency))
+        {
+            printf("FAIL  vector %d latency %lu above %ld cycles\n", i,
+                   (unsigned long)vec->lat_max, max_latency);
+            failed = 1;
+        }
+    }
+
+    for (i = 0; i < pin_count; i++)
+    {
+        Bench_Pin_t *pin = &pins[i];
+        double duty = 100.0 * (double)pin->high / (double)window;
+
+        printf("  P%c%u duty     %6.2f %%", pin->port, pin->bit, duty);
+        if (pin->expect >= 0.0)
+        {
+            int ok = (duty >= pin->expect - pin->tol) && (duty <= pin->expect + pin->tol);
+            printf("  (expect %.2f +/- %.2f) %s", pin->expect, pin->tol, ok ? "ok" : "FAIL");
+            failed |= !ok;
+        }
+        printf("\n");
+    }
+
+    printf("%s  %s\n", failed ? "FAIL" : "PASS", elf);
+    return failed;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file main.c
+ * @brief Load firmware of AVR_Common/soft_pwm.c for the simavr benchmark
+ *
+ * Gives every channel a different level and sleeps, so the only work left
+ * is the Timer2 compare ISR. The Makefile target soft-pwm-load builds it for
+ * 1..6 rows of soft_pwm_config.h and reports the load of that vector.
+ *
+ * Channel 0 (PB0) runs at level 11, 4.31 %.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#define F_CPU 16000000UL
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdint.h>
+#include "soft_pwm.h"
+
+int main(void)
+{
+    uint8_t ch;
+
+    SoftPwm_Init();
+    for (ch = 0U; ch < SOFT_PWM_CHANNELS; ch++)
+    {
+        /** 37 is odd, so the levels differ and use every bit plane */
+        SoftPwm_Set(ch, (uint8_t)((ch * 37U) + 11U));
+    }
+    SoftPwm_Commit();
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sei();
+
+    for (;;)
+    {
+        sleep_mode();
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file soft_pwm_config.h
+ * @brief Ports of the soft_pwm load firmware, SOFT_PWM_ROWS rows of them
+ *
+ * The Makefile builds the firmware once per row count with
+ * -DSOFT_PWM_ROWS=n. Rows take half ports so six rows fit the ATmega328P:
+ *
+ * Row 0: PB0..PB3, row 1: PC0..PC3, row 2: PD4..PD7,
+ * row 3: PB4..PB5, row 4: PC4..PC5, row 5: PD2..PD3.
+ *
+ * @author kandyala sai kumar
+ * @date 2025
+ */
+
+#ifndef SOFT_PWM_CONFIG_H
+#define SOFT_PWM_CONFIG_H
+
+#ifndef SOFT_PWM_ROWS
+#define SOFT_PWM_ROWS 1
+#endif
+
+#if (SOFT_PWM_ROWS < 1) || (SOFT_PWM_ROWS > 6)
+#error "SOFT_PWM_ROWS must be 1..6"
+#endif
+
+#define SOFT_PWM_ROWS_1(X) X(PORTB, DDRB, 0x0FU)
+#define SOFT_PWM_ROWS_2(X) SOFT_PWM_ROWS_1(X) X(PORTC, DDRC, 0x0FU)
+#define SOFT_PWM_ROWS_3(X) SOFT_PWM_ROWS_2(X) X(PORTD, DDRD, 0xF0U)
+#define SOFT_PWM_ROWS_4(X) SOFT_PWM_ROWS_3(X) X(PORTB, DDRB, 0x30U)
+#define SOFT_PWM_ROWS_5(X) SOFT_PWM_ROWS_4(X) X(PORTC, DDRC, 0x30U)
+#define SOFT_PWM_ROWS_6(X) SOFT_PWM_ROWS_5(X) X(PORTD, DDRD, 0x0CU)
+
+#define SOFT_PWM_ROWS_CAT(n)  SOFT_PWM_ROWS_CAT2(n)
+#define SOFT_PWM_ROWS_CAT2(n) SOFT_PWM_ROWS_##n
+
+#define SOFT_PWM_PORTS(X) SOFT_PWM_ROWS_CAT(SOFT_PWM_ROWS)(X)
+
+#endif /* SOFT_PWM_CONFIG_H */